@@ -0,0 +1,29 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_asm.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 主机(FreeRTOS POSIX移植)上与Cortex-M汇编指令等价的函数
+*******************************************************************************/
+
+#ifndef __LM_ASM_H
+#define __LM_ASM_H
+
+/**
+ * @brief 前导零个数, 与clz指令相同, x为0时返回32
+ */
+static inline unsigned int __clz(unsigned int x)
+{
+    return x ? (unsigned int)__builtin_clz(x) : 32;
+}
+
+#endif /* __LM_ASM_H */
+
+/* end of file */
@@ -0,0 +1,38 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_barrier.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 主机(FreeRTOS POSIX移植)上的内存屏障
+*******************************************************************************/
+
+#ifndef __LM_BARRIER_H
+#define __LM_BARRIER_H
+
+#define sev()       do { } while (0)
+#define wfe()       do { } while (0)
+#define wfi()       do { } while (0)
+
+#define isb(option) __sync_synchronize()
+#define dsb(option) __sync_synchronize()
+#define dmb(option) __sync_synchronize()
+
+/* The "volatile" is due to gcc bugs */
+#define barrier() __asm__ __volatile__("": : :"memory")
+
+#define mb()        __sync_synchronize()
+#define rmb()       __sync_synchronize()
+#define wmb()       __sync_synchronize()
+#define dma_rmb()   __sync_synchronize()
+#define dma_wmb()   __sync_synchronize()
+
+#endif /* __LM_BARRIER_H */
+
+/* end of file */
@@ -0,0 +1,71 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : FreeRTOSConfig.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : FreeRTOS POSIX移植(freertos/portable/GCC/Posix)的主机配置
+*
+* POSIX移植是协作式的, 任务只在阻塞, 延时或让出CPU时切换, 必须关闭抢占.
+* 任务代码运行在主机线程栈上, 任务栈只存放线程控制块.
+*******************************************************************************/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+
+#define configUSE_PREEMPTION                    0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     0
+#define configTICK_RATE_HZ                      ((TickType_t)1000)
+#define configMAX_PRIORITIES                    8
+#define configMINIMAL_STACK_SIZE                ((unsigned short)256)
+#define configMAX_TASK_NAME_LEN                 16
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_TASK_NOTIFICATIONS            1
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES           1
+#define configQUEUE_REGISTRY_SIZE               0
+#define configUSE_CO_ROUTINES                   0
+
+/* 内存分配, 动态分配使用heap_3(主机malloc) */
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configTOTAL_HEAP_SIZE                   ((size_t)(1024 * 1024))
+
+/* 软件定时器 */
+#define configUSE_TIMERS                        1
+#define configTIMER_TASK_PRIORITY               (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH                10
+#define configTIMER_TASK_STACK_DEPTH            256
+
+/* 任务线程的主机栈大小(字节) */
+#define configPOSIX_THREAD_STACK_SIZE           (256 * 1024)
+
+#define configASSERT(x)                         assert(x)
+
+#define INCLUDE_vTaskPrioritySet                1
+#define INCLUDE_uxTaskPriorityGet               1
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xQueueGetMutexHolder            1
+#define INCLUDE_xTimerPendFunctionCall          1
+
+#endif /* FREERTOS_CONFIG_H */
+
+/* end of file */
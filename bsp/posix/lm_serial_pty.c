@@ -0,0 +1,297 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_serial_pty.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 主机伪终端串口驱动(FreeRTOS POSIX移植下使用)
+*******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "lm_serial_pty.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* 接收任务的栈大小和优先级 */
+#ifndef LM_SERIAL_PTY_TASK_STACK
+#define LM_SERIAL_PTY_TASK_STACK        512
+#endif
+
+#ifndef LM_SERIAL_PTY_TASK_PRIO
+#define LM_SERIAL_PTY_TASK_PRIO         (configMAX_PRIORITIES - 1)
+#endif
+
+/* 伪终端写满(slave端没有程序在读)时最多等待的tick数, 超时后丢弃剩余数据 */
+#ifndef LM_SERIAL_PTY_WRITE_TICKS
+#define LM_SERIAL_PTY_WRITE_TICKS       10
+#endif
+
+/* 一个tick的时间(ns) */
+#define __PTY_TICK_NS                   (1000000UL * portTICK_PERIOD_MS)
+
+#define __pty_from_port(p_serial) \
+        ((struct lm_serial_pty *)(p_serial))
+
+/**
+ * @brief 模拟发送size字节的线路时间
+ */
+static void __pty_wire_delay (struct lm_serial_pty *p_pty, size_t size)
+{
+    uint64_t ns = (uint64_t)size * (p_pty->char_ns + p_pty->extra_ns);
+
+    if (ns >= __PTY_TICK_NS) {
+        vTaskDelay((TickType_t)(ns / __PTY_TICK_NS));
+    }
+}
+
+/**
+ * @brief 写入伪终端, 返回写入的字节数
+ *
+ * 调用者持有wr_mutex, 不能无限等待: 写满时让出CPU等待slave端读走数据,
+ * 超过LM_SERIAL_PTY_WRITE_TICKS仍写不进去则丢弃剩余数据
+ */
+static int __pty_write_all (struct lm_serial_pty *p_pty, const uint8_t *p_buf, size_t size)
+{
+    size_t   len  = 0;
+    uint32_t wait = 0;
+    ssize_t  ret;
+
+    while (len < size) {
+        ret = write(p_pty->fd, &p_buf[len], size - len);
+        if (ret >= 0) {
+            len += ret;
+            continue;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if ((errno != EAGAIN) || (wait >= LM_SERIAL_PTY_WRITE_TICKS)) {
+            break;
+        }
+
+        vTaskDelay(1);
+        wait++;
+    }
+
+    if (len < size) {
+        p_pty->tx_dropped += size - len;
+        if ((len == 0) && (errno != EAGAIN)) {
+            return -LM_EIO;
+        }
+    }
+
+    return (int)len;
+}
+
+/**
+ * @brief 配置
+ */
+static int __pty_set_config (struct lm_serial_port         *p_serial,
+                             const struct lm_serial_config *p_config)
+{
+    __pty_from_port(p_serial)->char_ns = lm_serial_char_time_ns(p_config);
+
+    return LM_OK;
+}
+
+/**
+ * @brief 发送数据
+ */
+static int __pty_send (struct lm_serial_port *p_serial,
+                       const void            *p_buf,
+                       size_t                 size)
+{
+    struct lm_serial_pty *p_pty = __pty_from_port(p_serial);
+    int                   ret;
+
+    ret = __pty_write_all(p_pty, p_buf, size);
+    if (ret > 0) {
+        __pty_wire_delay(p_pty, ret);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 分散发送
+ */
+static int __pty_sendv (struct lm_serial_port        *p_serial,
+                        const struct lm_serial_iovec *iov,
+                        int                           cnt)
+{
+    int i, ret, len = 0;
+
+    for (i = 0; i < cnt; i++) {
+        if ((iov[i].base == NULL) || (iov[i].len == 0)) {
+            continue;
+        }
+
+        ret = __pty_send(p_serial, iov[i].base, iov[i].len);
+        if (ret < 0) {
+            return (len > 0) ? len : ret;
+        }
+        len += ret;
+    }
+
+    return len;
+}
+
+/**
+ * @brief 发送一个字符
+ */
+static void __pty_poll_put_char (struct lm_serial_port *p_serial, uint8_t c)
+{
+    __pty_send(p_serial, &c, 1);
+}
+
+/**
+ * @brief 获取一个字符
+ */
+static int __pty_poll_get_char (struct lm_serial_port *p_serial)
+{
+    uint8_t c;
+
+    if (read(__pty_from_port(p_serial)->fd, &c, 1) != 1) {
+        return -1;
+    }
+
+    return c;
+}
+
+static const lm_serial_ops_t __g_pty_ops = {
+    .pfunc_set_config    = __pty_set_config,
+    .pfunc_send          = __pty_send,
+    .pfunc_sendv         = __pty_sendv,
+    .pfunc_poll_put_char = __pty_poll_put_char,
+    .pfunc_poll_get_char = __pty_poll_get_char,
+};
+
+/**
+ * @brief 接收任务, 代替接收中断
+ *
+ * 每个tick最多交付按波特率能收到的字节数, 一个tick内没有新数据时
+ * 视为接收空闲.
+ */
+static void __pty_rx_task (void *p_arg)
+{
+    struct lm_serial_pty *p_pty = (struct lm_serial_pty *)p_arg;
+    uint8_t               buf[256];
+    size_t                burst;
+    ssize_t               len;
+
+    for (;;) {
+        burst = sizeof(buf);
+        if (p_pty->char_ns + p_pty->extra_ns) {
+            burst = __PTY_TICK_NS / (p_pty->char_ns + p_pty->extra_ns);
+            burst = (burst == 0) ? 1 : (burst > sizeof(buf)) ? sizeof(buf) : burst;
+        }
+
+        len = read(p_pty->fd, buf, burst);
+        if (len > 0) {
+            lm_uart_port_rx_burst(&p_pty->port, buf, len);
+            p_pty->idle = 0;
+        } else if (!p_pty->idle) {
+            lm_uart_port_rx_flush(&p_pty->port);
+            p_pty->idle = 1;
+        }
+
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * @brief 创建伪终端串口并注册
+ */
+int lm_serial_pty_init (struct lm_serial_pty *p_pty,
+                        int                   com,
+                        uint8_t              *recv_buf,
+                        uint32_t              buf_size)
+{
+    struct termios            tio;
+    struct lm_serial_config   config = LM_SERIAL_CONFIG_DEFAULT;
+    const char               *name;
+    int                       ret;
+
+    if ((p_pty == NULL) || (recv_buf == NULL)) {
+        return -LM_EINVAL;
+    }
+
+    memset(p_pty, 0, sizeof(*p_pty));
+
+    /* 1.打开伪终端 */
+    p_pty->fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (p_pty->fd < 0) {
+        return -LM_EIO;
+    }
+
+    if (grantpt(p_pty->fd) || unlockpt(p_pty->fd) ||
+        ((name = ptsname(p_pty->fd)) == NULL)) {
+        close(p_pty->fd);
+        return -LM_EIO;
+    }
+    snprintf(p_pty->slave_name, sizeof(p_pty->slave_name), "%s", name);
+
+    /* 2.原始模式, 非阻塞读 */
+    if (tcgetattr(p_pty->fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(p_pty->fd, TCSANOW, &tio);
+    }
+    fcntl(p_pty->fd, F_SETFL, fcntl(p_pty->fd, F_GETFL) | O_NONBLOCK);
+
+    /* 3.注册串口 */
+    p_pty->port.recv_buf = recv_buf;
+    p_pty->port.buf_size = buf_size;
+    p_pty->port.id       = com;
+    p_pty->port.p_ops    = &__g_pty_ops;
+    p_pty->char_ns       = lm_serial_char_time_ns(&config);
+    p_pty->idle          = 1;
+
+    ret = lm_serial_register(&p_pty->port);
+    if (ret != LM_OK) {
+        close(p_pty->fd);
+        return ret;
+    }
+
+    if (lm_task_create("pty_rx", __pty_rx_task, LM_SERIAL_PTY_TASK_STACK,
+                       LM_SERIAL_PTY_TASK_PRIO, p_pty) != LM_TYPE_PASS) {
+        lm_serial_unregister(com);
+        close(p_pty->fd);
+        return -LM_ENOMEM;
+    }
+
+    return LM_OK;
+}
+
+/**
+ * @brief 获取伪终端slave路径
+ */
+const char *lm_serial_pty_get_name (struct lm_serial_pty *p_pty)
+{
+    return (p_pty != NULL) ? p_pty->slave_name : NULL;
+}
+
+/**
+ * @brief 设置每个字符额外的延时
+ */
+void lm_serial_pty_set_delay (struct lm_serial_pty *p_pty, uint32_t extra_ns)
+{
+    if (p_pty != NULL) {
+        p_pty->extra_ns = extra_ns;
+    }
+}
+
+/* end of file */
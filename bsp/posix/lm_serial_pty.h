@@ -0,0 +1,83 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_serial_pty.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 主机伪终端串口驱动(FreeRTOS POSIX移植下使用)
+*******************************************************************************/
+
+#ifndef __LM_SERIAL_PTY_H
+#define __LM_SERIAL_PTY_H
+
+#include "lm_serial.h"
+
+LM_BEGIN_EXTERN_C
+
+/*
+ * 用法:
+ *   lm_serial_pty_init()打开一对伪终端并注册串口, 主机上的其他程序
+ *   (minicom, pymodbus, 脚本等)打开lm_serial_pty_get_name()返回的路径
+ *   即可与shell, ulog, Modbus从站通信. 接收任务按模拟的波特率把数据交给
+ *   串口框架, 发送按模拟的波特率延时, 可以在开发机上测试时序相关的逻辑.
+ *
+ *   运行在FreeRTOS POSIX移植(freertos/portable/GCC/Posix, 配置见
+ *   bsp/posix/FreeRTOSConfig.h)上, 编译命令见tests/host/test_serial_pty.c.
+ *   移植是协作式的, 任务中轮询时要用vTaskDelay()或阻塞接口让出CPU.
+ */
+struct lm_serial_pty
+{
+    struct lm_serial_port       port;
+
+    int                         fd;                 /* 伪终端master */
+    char                        slave_name[64];     /* 伪终端slave路径 */
+
+    uint32_t                    char_ns;            /* 每个字符的传输时间(ns) */
+    uint32_t                    extra_ns;           /* 每个字符额外的延时(ns) */
+    uint8_t                     idle;               /* 接收已经空闲 */
+    uint32_t                    tx_dropped;         /* slave端不读, 写超时丢弃的字节数 */
+};
+
+/**
+ * @brief 创建伪终端串口并注册
+ *
+ * @param[in] p_pty    伪终端串口
+ * @param[in] com      串口号
+ * @param[in] recv_buf 接收缓存区
+ * @param[in] buf_size 接收缓存区大小
+ *
+ * @return LM_OK 成功, 其他 失败
+ */
+extern int lm_serial_pty_init (struct lm_serial_pty *p_pty,
+                               int                   com,
+                               uint8_t              *recv_buf,
+                               uint32_t              buf_size);
+
+/**
+ * @brief 设置每个字符额外的延时, 模拟对端字符间隙
+ *
+ * @param[in] p_pty    伪终端串口
+ * @param[in] extra_ns 额外的延时(ns)
+ */
+extern void lm_serial_pty_set_delay (struct lm_serial_pty *p_pty, uint32_t extra_ns);
+
+/**
+ * @brief 获取伪终端slave路径(如/dev/pts/3), 由应用决定如何打印
+ *
+ * @param[in] p_pty    伪终端串口
+ *
+ * @return slave路径, p_pty为NULL时返回NULL
+ */
+extern const char *lm_serial_pty_get_name (struct lm_serial_pty *p_pty);
+
+LM_END_EXTERN_C
+
+#endif /* __LM_SERIAL_PTY_H */
+
+/* end of file */
@@ -0,0 +1,31 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : status.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 主机上代替芯片SDK的status.h, 只包含OSIF用到的状态码,
+*                 取值与SDK相同
+*******************************************************************************/
+
+#ifndef STATUS_H
+#define STATUS_H
+
+typedef enum
+{
+    STATUS_SUCCESS     = 0x000U,
+    STATUS_ERROR       = 0x001U,
+    STATUS_BUSY        = 0x002U,
+    STATUS_TIMEOUT     = 0x003U,
+    STATUS_UNSUPPORTED = 0x004U,
+} status_t;
+
+#endif /* STATUS_H */
+
+/* end of file */
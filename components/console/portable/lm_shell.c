@@ -19,6 +19,7 @@
 #include "mini-printf.h"
 
 #include "lm_kservice.h"
+#include "lm_heap.h"
 
 #define __CONSOLE_TASK_PRIO            10           /* 控制台任务优先级 */
 #define __CONSOLE_TASK_STACK           256          /* 控制台任务栈深度 */
@@ -112,6 +113,110 @@ int lm_shell_register (lm_console_t *p_cole)
     return ret;
 }
 
+/******************************************************************************/
+/********************************** 调试命令 ***********************************/
+/******************************************************************************/
+
+#if LM_RINGBUF_STAT_ENABLED
+/**
+ * @brief 打印各串口接收环形缓存区统计
+ */
+static int __shell_cmd_rbstat (int argc, char *argv[])
+{
+    struct lm_ringbuf_stat stat;
+
+    for (int com = COM0; com < COM_MUX; com++) {
+        if (lm_serial_get_ringbuf_stat(com, &stat) != LM_OK) {
+            continue;
+        }
+
+        lm_kprintf("COM%d high=%u dropped=%u overwrite=%u/%u truncated=%u "
+                   "in=%u out=%u\r\n",
+                   com,
+                   stat.high_water,
+                   stat.dropped,
+                   stat.overwrite_count,
+                   stat.overwritten,
+                   stat.truncated,
+                   stat.total_in,
+                   stat.total_out);
+    }
+
+    return LM_OK;
+}
+lm_shell_cmd_export(rbstat, __shell_cmd_rbstat, serial rx ring buffer statistics);
+#endif
+
+#if LM_SERIAL_PERF_ENABLED
+/**
+ * @brief 打印各串口性能统计, 带参数-c时打印后清零
+ */
+static int __shell_cmd_serstat (int argc, char *argv[])
+{
+    struct lm_serial_perf    perf;
+    struct lm_serial_rx_stat rx;
+    int                      i;
+
+    for (int com = COM0; com < COM_MUX; com++) {
+        if ((lm_serial_get_perf(com, &perf) != LM_OK) ||
+            (lm_serial_get_rx_stat(com, &rx) != LM_OK)) {
+            continue;
+        }
+
+        lm_kprintf("COM%d rx=%u tx=%u reads=%u wakeups=%u writes=%u "
+                   "drop=%u ferr=%u perr=%u oerr=%u lock=%u/%u\r\n",
+                   com,
+                   perf.rx_bytes,
+                   perf.tx_bytes,
+                   perf.reads,
+                   perf.read_wakeups,
+                   perf.writes,
+                   rx.dropped,
+                   perf.frame_errors,
+                   perf.parity_errors,
+                   perf.hw_overruns,
+                   perf.lock_wait_max,
+                   perf.lock_wait_total);
+
+        lm_kprintf("COM%d write_us max=%u hist=", com, perf.write_max_us);
+        for (i = 0; i < LM_SERIAL_PERF_HIST_BINS; i++) {
+            lm_kprintf(i ? ",%u" : "%u", perf.write_hist[i]);
+        }
+        lm_kprintf("\r\n");
+
+        if ((argc > 1) && (strcmp(argv[1], "-c") == 0)) {
+            lm_serial_clear_perf(com);
+        }
+    }
+
+    return LM_OK;
+}
+lm_shell_cmd_export(serstat, __shell_cmd_serstat, serial performance counters [-c]);
+#endif
+
+#if LM_RINGBUF_BENCH_ENABLED
+/**
+ * @brief 环形缓冲区性能测试
+ */
+static int __shell_cmd_rbbench (int argc, char *argv[])
+{
+    int      ret;
+    uint8_t *pool = lm_mem_alloc(4096);
+
+    if (NULL == pool) {
+        lm_kprintf("rbbench: no memory\r\n");
+        return -LM_ENOMEM;
+    }
+
+    ret = lm_ringbuf_bench(pool, 4096);
+
+    lm_mem_free(pool);
+
+    return ret;
+}
+lm_shell_cmd_export(rbbench, __shell_cmd_rbbench, ring buffer benchmark (csv));
+#endif
+
 /******************************************************************************/
 /********************************** 格式化输出 ***********************************/
 /******************************************************************************/
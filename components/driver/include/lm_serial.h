@@ -22,6 +22,28 @@ enum lm_com_id {
 
 struct lm_serial_port;
 
+/**
+ * @brief 是否使能串口性能统计
+ */
+#ifndef LM_SERIAL_PERF_ENABLED
+#define LM_SERIAL_PERF_ENABLED            0
+#endif
+
+/**
+ * @brief 写完成时间直方图的档数, 第n档为[2^(n-1), 2^n)us, 第0档为不足1us,
+ *        最后一档包含所有更长的时间
+ *
+ * 时间来自lm_us_stamp(), 没有周期计数器的内核上只有节拍精度
+ */
+#define LM_SERIAL_PERF_HIST_BINS          16
+
+/**
+ * @brief 分散发送的数据片段
+ */
+struct lm_serial_iovec {
+    const void                 *base;               /* 片段地址 */
+    size_t                      len;                /* 片段长度 */
+};
 
 /**
  * @brief 波特率
@@ -102,7 +124,8 @@ struct lm_serial_config {
 {                                  \
         LM_SERIAL_CONFIG_DEFAULT,  \
         0x0,                       \
-        0xFFFFFFFF                 \
+        0xFFFFFFFF,                \
+        0                          \
 }
 
 struct lm_serial_info
@@ -111,8 +134,29 @@ struct lm_serial_info
 
     uint32_t       read_timeout;                /* 读超时 */
     uint32_t       idle_timeout;                /* 空闲超时 */
+
+    /*
+     * 空闲超时(字符时间), 0:使用idle_timeout. 按波特率和帧格式换算,
+     * 由硬件接收超时(pfunc_set_rx_timeout)检测帧结束. 驱动不支持时
+     * 需要或上LM_SERIAL_IDLE_SW_OK才会退化为软件空闲超时
+     */
+    uint32_t       idle_chars;
 };
 
+/**
+ * @brief idle_chars标志: 没有硬件接收超时时允许使用软件空闲超时
+ *
+ * 没有亚毫秒的软件实现: 软件空闲超时按tick等待, 字符时间换算成ms后
+ * 向上取整, 至少1ms, 代替idle_timeout. 不带此标志而驱动不支持硬件
+ * 接收超时, lm_serial_set_info()返回-LM_ENOTSUP
+ */
+#define LM_SERIAL_IDLE_SW_OK              0x80000000UL
+
+/**
+ * @brief 从idle_chars中取出字符数
+ */
+#define LM_SERIAL_IDLE_CHARS(idle_chars)  ((idle_chars) & ~LM_SERIAL_IDLE_SW_OK)
+
 /**
  * @brief 串口服务函数
  */
@@ -140,6 +184,16 @@ typedef struct lm_serial_ops_t {
     int (*pfunc_send_dma) ( struct lm_serial_port *p_serial,
                             const void            *p_buf,
                             size_t                 size);
+    /**
+     * @brief 分散发送(可选)
+     *
+     * 按顺序发送cnt个片段, 驱动可以把片段串成DMA描述符链或依次填入FIFO,
+     * 不需要先拷贝到一个缓存区. 返回发送的总字节数
+     */
+    int (*pfunc_sendv) (struct lm_serial_port        *p_serial,
+                        const struct lm_serial_iovec *iov,
+                        int                           cnt);
+
     /**
      * @brief 发送一个字符
      */
@@ -150,9 +204,105 @@ typedef struct lm_serial_ops_t {
      */
     int (*pfunc_poll_get_char) (struct lm_serial_port *p_serial);
 
+    /**
+     * @brief 获取循环DMA接收的当前写位置(可选)
+     *
+     * 驱动把接收DMA配置成循环模式, 直接写入recv_buf(长度buf_size),
+     * 返回DMA当前写入位置相对recv_buf的偏移(一般为buf_size - 剩余计数)
+     */
+    uint32_t (*pfunc_get_rx_dma_pos) (struct lm_serial_port *p_serial);
+
+    /**
+     * @brief 设置硬件接收超时(可选)
+     *
+     * 接收线空闲chars个字符时间后产生中断, 驱动在中断中调用
+     * lm_uart_port_rx_flush(). chars为0时关闭. 不支持时返回负数
+     */
+    int (*pfunc_set_rx_timeout) (struct lm_serial_port *p_serial, uint32_t chars);
+
+    /**
+     * @brief 启动异步发送(可选)
+     *
+     * 发送队列中有新数据时调用. 驱动打开发送中断或启动DMA, 在中断中通过
+     * lm_uart_port_tx_get()或lm_uart_port_tx_peek()/lm_uart_port_tx_done()
+     * 取数据, 已经在发送时直接返回即可
+     */
+    void (*pfunc_tx_start) (struct lm_serial_port *p_serial);
+
 } lm_serial_ops_t;
 
 
+/**
+ * @brief 批量接收统计
+ *
+ * 逐字节接收时每个字节都可能唤醒一次读任务,
+ * 因此节省的唤醒次数 = bytes - wakeups
+ */
+struct lm_serial_rx_stat {
+    uint32_t                    bursts;             /* 接收突发次数 */
+    uint32_t                    bytes;              /* 接收字节数 */
+    uint32_t                    dropped;            /* 缓存区满丢弃的字节数 */
+    uint32_t                    wakeups;            /* 唤醒读任务的次数 */
+};
+
+/**
+ * @brief 驱动上报的接收错误
+ */
+#define LM_SERIAL_ERR_FRAME               0x01    /* 帧错误 */
+#define LM_SERIAL_ERR_PARITY              0x02    /* 校验错误 */
+#define LM_SERIAL_ERR_OVERRUN             0x04    /* 硬件接收溢出 */
+
+/**
+ * @brief 串口性能统计(需要使能LM_SERIAL_PERF_ENABLED)
+ *
+ * 接收字节数, 缓存区满丢弃和唤醒次数见struct lm_serial_rx_stat
+ */
+struct lm_serial_perf {
+    uint32_t                    rx_bytes;           /* 读出的字节数 */
+    uint32_t                    tx_bytes;           /* 写入的字节数 */
+    uint32_t                    reads;              /* 读次数 */
+    uint32_t                    read_wakeups;       /* 读任务被唤醒的次数 */
+    uint32_t                    writes;             /* 同步写次数 */
+    uint32_t                    frame_errors;       /* 帧错误 */
+    uint32_t                    parity_errors;      /* 校验错误 */
+    uint32_t                    hw_overruns;        /* 硬件接收溢出 */
+    uint32_t                    lock_wait_total;    /* 等待读写锁的总时间(ms) */
+    uint32_t                    lock_wait_max;      /* 等待读写锁的最长时间(ms) */
+    uint32_t                    write_max_us;       /* 同步写的最长时间(us) */
+    uint32_t                    write_hist[LM_SERIAL_PERF_HIST_BINS]; /* 同步写时间分布 */
+};
+
+/**
+ * @brief 不使用分隔符唤醒
+ */
+#define LM_SERIAL_RX_DELIM_NONE           (-1)
+
+/**
+ * @brief 接收唤醒条件(任务通知方式)
+ *
+ * 满足任一条件时驱动直接通知正在lm_serial_read()中等待的任务,
+ * 读满请求长度时总会唤醒. 因分隔符或空闲唤醒时读函数返回已读到的数据.
+ */
+struct lm_serial_rx_trigger {
+    uint32_t                    level;              /* 可读数据达到该字节数时唤醒,0:不使用 */
+    int16_t                     delimiter;          /* 收到该字节时唤醒 */
+    uint8_t                     idle;               /* 1:接收空闲时唤醒 */
+};
+
+/**
+ * @brief DMA多缓存接收的最大缓存个数
+ */
+#ifndef LM_SERIAL_RX_BLOCK_MAX
+#define LM_SERIAL_RX_BLOCK_MAX            4
+#endif
+
+/**
+ * @brief 发送队列满时的处理方式
+ */
+#define LM_SERIAL_TX_BLOCK                0       /* 等待空间, 超时返回已写入的长度 */
+#define LM_SERIAL_TX_DROP                 1       /* 放不下时整段丢弃 */
+#define LM_SERIAL_TX_OVERWRITE            2       /* 丢弃最早的未发送数据 */
+
 /**
  * @brief
  */
@@ -167,10 +317,54 @@ struct lm_serial_port {
     struct lm_ringbuf           rbuf;
 
     struct lm_serial_info       serial_info;
+    uint32_t                    info_seq;           /* serial_info的顺序锁, 奇数表示正在更新 */
     lm_mutex_t                  ro_mutex;
     lm_mutex_t                  wr_mutex;
     lm_semb_t                   ro_sync_semb;
     const lm_serial_ops_t       *p_ops;             /* 串口操作函数,由底层驱动去实现 */
+
+    uint32_t                    rx_watermark;       /* 接收水位,0:每个突发都唤醒读任务 */
+    struct lm_serial_rx_stat    rx_stat;            /* 批量接收统计 */
+
+    uint8_t                     rx_notify;          /* 1:使用任务通知唤醒读任务 */
+    struct lm_serial_rx_trigger rx_trigger;         /* 任务通知方式的唤醒条件 */
+    lm_task_handle_t            rx_waiter;          /* 正在等待接收的任务 */
+    uint32_t                    rx_want;            /* 读任务本次等待的字节数 */
+    lm_task_handle_t            rx_select;          /* 在lm_serial_wait_any()中等待的任务 */
+    uint32_t                    rx_idle_ms;         /* 生效的空闲超时(ms) */
+    uint8_t                     rx_hw_idle;         /* 1:由硬件接收超时检测帧结束 */
+    uint8_t                     rx_idle_flag;       /* 收到数据后检测到接收空闲 */
+
+    uint8_t                    *send_buf;           /* 发送队列缓存区的地址,NULL:不使用 */
+    uint32_t                    send_buf_size;      /* 发送队列缓存区大小 */
+    struct lm_ringbuf           tbuf;               /* 发送队列 */
+    lm_semb_t                   tx_space_semb;      /* 发送队列有空闲空间 */
+    lm_semb_t                   tx_done_semb;       /* 发送完成(见tx_tc) */
+    uint8_t                     tx_policy;          /* 发送队列满时的处理方式 */
+    uint32_t                    tx_timeout;         /* LM_SERIAL_TX_BLOCK的等待超时 */
+    uint32_t                    tx_inflight;        /* DMA正在发送的长度 */
+    uint8_t                     tx_tc;              /* 1:驱动在TC中断中调用lm_uart_port_tx_complete(),
+                                                       0:队列排空即视为发送完成 */
+    uint32_t                    tx_hw_busy;         /* 取走的数据还在硬件中发送(等待TC) */
+    uint32_t                    tx_dropped;         /* 队列满丢弃或覆盖的字节数 */
+
+    /*
+     * DMA多缓存接收: recv_buf平均分成rx_block_num块, 按顺序轮流使用.
+     * 驱动填充一块的同时应用可以借用已填满的块, 归还后驱动才会再次使用,
+     * 因此处理过程中数据不会被覆盖. 所有块都被占用时驱动重复使用当前块,
+     * 新数据被丢弃.
+     */
+    uint8_t                     rx_block_num;       /* 缓存块个数,小于2:不使用 */
+    uint32_t                    rx_block_size;      /* 每块大小 */
+    uint32_t                    rx_block_len[LM_SERIAL_RX_BLOCK_MAX]; /* 每块数据长度 */
+    uint32_t                    rx_block_head;      /* 已填满的块计数(驱动) */
+    uint32_t                    rx_block_borrow;    /* 已借出的块计数(应用) */
+    uint32_t                    rx_block_tail;      /* 已归还的块计数(应用) */
+    uint32_t                    rx_block_dropped;   /* 没有空闲块丢弃的次数 */
+
+#if LM_SERIAL_PERF_ENABLED
+    struct lm_serial_perf       perf;               /* 性能统计 */
+#endif
 };
 
 static inline void
@@ -179,17 +373,213 @@ lm_uart_port_rx(struct lm_serial_port *p_serial, const uint8_t c)
     lm_ringbuf_putchar(&p_serial->rbuf, c);
 }
 
+/**
+ * @brief 上报接收错误(在接收中断中调用)
+ *
+ * @param[in] p_serial 串口端口
+ * @param[in] errors   LM_SERIAL_ERR_FRAME等错误标志的组合
+ */
+static inline void
+lm_uart_port_rx_error(struct lm_serial_port *p_serial, uint32_t errors)
+{
+#if LM_SERIAL_PERF_ENABLED
+    if (errors & LM_SERIAL_ERR_FRAME) {
+        p_serial->perf.frame_errors++;
+    }
+    if (errors & LM_SERIAL_ERR_PARITY) {
+        p_serial->perf.parity_errors++;
+    }
+    if (errors & LM_SERIAL_ERR_OVERRUN) {
+        p_serial->perf.hw_overruns++;
+    }
+#else
+    (void)p_serial;
+    (void)errors;
+#endif
+}
+
+/**
+ * @brief 批量接收(在接收中断中调用, 一次传入FIFO突发或DMA数据块)
+ *
+ * 整块数据只写一次环形缓存区. rx_watermark为0时每个突发唤醒一次读任务,
+ * 否则只在缓存区数据量达到水位时唤醒, 剩余不足水位的数据由
+ * lm_uart_port_rx_flush()在接收空闲时唤醒. 设置了接收唤醒条件时
+ * 改为按lm_serial_set_rx_trigger()的条件通知读任务.
+ *
+ * @param[in] p_serial 串口端口
+ * @param[in] p_buf    接收到的数据
+ * @param[in] size     数据长度
+ *
+ * @return 写入环形缓存区的字节数
+ */
+extern size_t lm_uart_port_rx_burst (struct lm_serial_port *p_serial,
+                                     const uint8_t         *p_buf,
+                                     size_t                 size);
+
+/**
+ * @brief 接收空闲(空闲线中断或DMA接收超时)时调用, 缓存区有数据则唤醒读任务
+ *
+ * @param[in] p_serial 串口端口
+ */
+extern void lm_uart_port_rx_flush (struct lm_serial_port *p_serial);
+
+/**
+ * @brief 循环DMA接收事件(半传输, 传输完成, 空闲线中断中调用)
+ *
+ * 通过pfunc_get_rx_dma_pos()读取DMA写位置并发布到环形缓存区,
+ * 数据由DMA直接写入, 读任务读取前CPU不接触数据. 唤醒规则同批量接收.
+ * 使用该方式时transmit_type保持为0(环形缓存区读).
+ *
+ * @param[in] p_serial 串口端口
+ *
+ * @return 新发布的数据长度
+ */
+extern size_t lm_uart_port_rx_dma_event (struct lm_serial_port *p_serial);
+
+/**
+ * @brief 设置接收唤醒条件
+ *
+ * 设置后lm_serial_read()改为等待任务通知, 只在满足唤醒条件时被唤醒,
+ * 读一帧数据只需要一次任务切换. 驱动必须通过lm_uart_port_rx_burst(),
+ * lm_uart_port_rx_dma_event()和lm_uart_port_rx_flush()上报接收.
+ *
+ * @param[in] com       串口号
+ * @param[in] p_trigger 唤醒条件, NULL:恢复为信号量方式
+ */
+extern int lm_serial_set_rx_trigger (int                                com,
+                                     const struct lm_serial_rx_trigger *p_trigger);
+
+/**
+ * @brief DMA多缓存接收: 获取驱动当前应该填充的缓存块(启动DMA时调用)
+ *
+ * @param[in] p_serial 串口端口
+ *
+ * @return 缓存块地址, 块大小为rx_block_size
+ */
+extern uint8_t *lm_uart_port_rx_block_get (struct lm_serial_port *p_serial);
+
+/**
+ * @brief DMA多缓存接收: 当前块接收完成(在DMA完成或空闲线中断中调用)
+ *
+ * @param[in] p_serial 串口端口
+ * @param[in] len      当前块接收到的数据长度
+ *
+ * @return 下一次应该填充的缓存块地址, 驱动用它重新启动DMA
+ */
+extern uint8_t *lm_uart_port_rx_block_done (struct lm_serial_port *p_serial,
+                                            uint32_t               len);
+
+/**
+ * @brief 从发送队列取数据(在发送中断中调用, 逐字节或FIFO方式发送)
+ *
+ * @param[in]  p_serial 串口端口
+ * @param[out] p_buf    存放数据的地址
+ * @param[in]  size     最多取出的字节数
+ *
+ * @return 取出的字节数, 0表示队列已空, 驱动应关闭发送中断
+ */
+extern size_t lm_uart_port_tx_get (struct lm_serial_port *p_serial,
+                                   uint8_t               *p_buf,
+                                   size_t                 size);
+
+/**
+ * @brief 获取发送队列中第一段连续数据(DMA方式发送)
+ *
+ * 数据在lm_uart_port_tx_done()之前保留在队列中, DMA直接从队列发送.
+ *
+ * @param[in]  p_serial 串口端口
+ * @param[out] pp_data  数据地址
+ *
+ * @return 连续数据的长度, 0表示队列已空
+ */
+extern size_t lm_uart_port_tx_peek (struct lm_serial_port  *p_serial,
+                                    const uint8_t         **pp_data);
+
+/**
+ * @brief DMA发送完成(在DMA完成中断中调用)
+ *
+ * @param[in] p_serial 串口端口
+ * @param[in] len      已发送的长度(lm_uart_port_tx_peek()返回的长度)
+ */
+extern void lm_uart_port_tx_done (struct lm_serial_port *p_serial, size_t len);
+
+/**
+ * @brief 发送完成(在TC中断中调用, 最后一个字节已经移出移位寄存器)
+ *
+ * 只有tx_tc为1的驱动调用. 此时lm_serial_flush()等到TC才返回,
+ * 之后可以安全地切换RS-485方向或关闭串口.
+ *
+ * @param[in] p_serial 串口端口
+ */
+extern void lm_uart_port_tx_complete (struct lm_serial_port *p_serial);
+
+/**
+ * @brief 获取批量接收统计
+ *
+ * @param[in]  com    串口号
+ * @param[out] p_stat 存放统计数据的地址
+ */
+extern int lm_serial_get_rx_stat (int com, struct lm_serial_rx_stat *p_stat);
+
+/**
+ * @brief 获取串口性能统计
+ *
+ * @param[in]  com    串口号
+ * @param[out] p_perf 存放统计数据的地址
+ *
+ * @return LM_OK 成功, -LM_ENOTSUP 未使能LM_SERIAL_PERF_ENABLED
+ */
+extern int lm_serial_get_perf (int com, struct lm_serial_perf *p_perf);
+
+/**
+ * @brief 清除串口性能统计和批量接收统计
+ *
+ * @param[in] com 串口号
+ */
+extern int lm_serial_clear_perf (int com);
+
+/**
+ * @brief 获取串口接收环形缓存区统计(需要使能LM_RINGBUF_STAT_ENABLED)
+ *
+ * @param[in]  com    串口号
+ * @param[out] p_stat 存放统计数据的地址
+ */
+extern int lm_serial_get_ringbuf_stat (int com, struct lm_ringbuf_stat *p_stat);
+
+/**
+ * @brief 计算一个字符的传输时间
+ *
+ * 起始位 + 数据位 + 校验位 + 停止位
+ *
+ * @param[in] p_config 串口配置
+ *
+ * @return 字符时间(ns), 波特率为0时返回0
+ */
+extern uint32_t lm_serial_char_time_ns (const struct lm_serial_config *p_config);
+
 /**
  * @brief 配置串口
  *
+ * 只与写操作互斥, 不等待正在进行的读: 读任务在下一次读时使用新的
+ * 超时配置, 正在等待的读按开始时取得的read_timeout和空闲超时快照结束.
+ * 硬件接收超时(idle_chars)立即重新设置, 正在进行的读如果因此收不到
+ * 硬件空闲通知, 由快照中的软件空闲超时结束.
+ * 修改transmit_type(接收方式)时需要等待正在进行的读结束.
+ *
  * @param[in] com    串口号
  * @param[in] p_info 串口配置数据
+ *
+ * @return LM_OK成功, -LM_ENOTSUP idle_chars需要硬件接收超时而驱动不支持
+ *         (见LM_SERIAL_IDLE_SW_OK), 此时串口保持原来的配置
  */
 extern int lm_serial_set_info (int com, const struct lm_serial_info *p_info);
 
 /**
  * @brief 获取串口配置信息
  *
+ * 通过顺序锁读取配置快照, 不获取读写锁, 读任务阻塞在lm_serial_read()
+ * 中时也能立即返回.
+ *
  * @param[in] com    串口号
  * @param[in] p_info 存放串口配置数据的地址
  */
@@ -217,6 +607,106 @@ extern int lm_serial_get_serial_port (int com, struct lm_serial_port *p_serial);
  */
 extern int lm_serial_write (int com, const void *p_buf, size_t size);
 
+/**
+ * @brief 借用一块已接收的数据(DMA多缓存接收, 零拷贝)
+ *
+ * 归还之前驱动不会再写入该块. 可以连续借用多块, 按借用顺序归还.
+ *
+ * @param[in]  com     串口号
+ * @param[out] pp_data 数据地址
+ * @param[in]  timeout 超时(ms)
+ *
+ * @return 成功:返回数据长度,
+ *         失败:返回负数(错误码), 超时返回-LM_ETIMEOUT.
+ */
+extern int lm_serial_rx_borrow (int com, const uint8_t **pp_data, uint32_t timeout);
+
+/**
+ * @brief 归还最早借用的数据块
+ *
+ * @param[in] com 串口号
+ */
+extern int lm_serial_rx_return (int com);
+
+/**
+ * @brief 获取串口可读的字节数
+ *
+ * @param[in] com 串口号
+ *
+ * @return 可读的字节数(DMA多缓存接收时为下一块的长度), 失败返回负数
+ */
+extern int lm_serial_rx_available (int com);
+
+/**
+ * @brief 等待多个串口中任意一个有数据可读
+ *
+ * 一个任务可以同时服务多个串口, 返回后对就绪的串口调用lm_serial_read()
+ * 或lm_serial_rx_borrow()读取. 等待期间任务登记在mask中的每个串口上,
+ * 接收中断直接用任务通知唤醒它, 返回前注销. 一个串口同一时间只能由
+ * 一个任务等待, 不同任务可以等待不相交的串口.
+ *
+ * @param[in] mask    等待的串口, 第n位对应COMn
+ * @param[in] timeout 超时(ms)
+ *
+ * @return 大于0: 有数据可读的串口掩码,
+ *         0: 超时,
+ *         -LM_EBUSY: mask中的串口正在被其他任务等待,
+ *         其他负数: 错误码.
+ */
+extern int lm_serial_wait_any (uint32_t mask, uint32_t timeout);
+
+/**
+ * @brief 串口设备分散写数据
+ *
+ * 多个片段作为一次写入发送, 中间不会插入其他任务的数据.
+ * 驱动没有实现pfunc_sendv时逐个片段调用pfunc_send.
+ *
+ * @param[in] com 串口号
+ * @param[in] iov 片段数组
+ * @param[in] cnt 片段个数
+ *
+ * @return 成功:返回写入数据的总字节数,
+ *         失败:返回负数(错误码).
+ */
+extern int lm_serial_writev (int com, const struct lm_serial_iovec *iov, int cnt);
+
+/**
+ * @brief 串口设备异步写数据
+ *
+ * 数据放入发送队列后立即返回, 由驱动在中断或DMA中发送.
+ * 需要驱动提供send_buf和pfunc_tx_start.
+ *
+ * @param[in] com   串口号
+ * @param[in] p_buf 需要写入数据的缓存区地址
+ * @param[in] size  需要写入数据的字节数
+ *
+ * @return 成功:返回放入发送队列的字节数(队列满时按处理方式可能小于size),
+ *         失败:返回负数(错误码).
+ */
+extern int lm_serial_write_async (int com, const void *p_buf, size_t size);
+
+/**
+ * @brief 设置发送队列满时的处理方式
+ *
+ * @param[in] com     串口号
+ * @param[in] policy  LM_SERIAL_TX_BLOCK/LM_SERIAL_TX_DROP/LM_SERIAL_TX_OVERWRITE
+ * @param[in] timeout LM_SERIAL_TX_BLOCK的等待超时(ms)
+ */
+extern int lm_serial_set_tx_policy (int com, int policy, uint32_t timeout);
+
+/**
+ * @brief 等待发送队列中的数据全部发送完成
+ *
+ * 驱动设置了tx_tc时等到最后一个字节从硬件发出(TC); 否则只能等到队列排空,
+ * 最后几个字节可能还在硬件FIFO或移位寄存器中.
+ *
+ * @param[in] com     串口号
+ * @param[in] timeout 超时(ms)
+ *
+ * @return LM_OK 发送完成, -LM_ETIMEOUT 超时
+ */
+extern int lm_serial_flush (int com, uint32_t timeout);
+
 /**
  * @brief 串口设备写数据
  *
@@ -229,11 +719,73 @@ extern int lm_serial_write (int com, const void *p_buf, size_t size);
  */
 extern int lm_serial_read (int com, void *p_buf, size_t size);
 
+/**
+ * @brief 长度前缀帧格式
+ *
+ * 帧总长 = 长度字段的值 + len_adjust, 例如帧格式为
+ * [0xAA][len][payload][crc]且len为payload长度时,
+ * len_offset = 1, len_size = 1, len_adjust = 3.
+ */
+struct lm_serial_frame_fmt {
+    uint16_t                    len_offset;         /* 长度字段在帧中的偏移 */
+    uint8_t                     len_size;           /* 长度字段字节数(1或2) */
+    uint8_t                     big_endian;         /* 长度字段为大端 */
+    int16_t                     len_adjust;         /* 帧总长与长度字段值的差 */
+};
+
+/**
+ * @brief 读取一帧, 以分隔符结束
+ *
+ * 直接在接收环形缓存区中查找分隔符, 只取出完整的一帧(包括分隔符),
+ * 之后的数据留给下一次读取. 超时使用read_timeout, 不使用码间超时.
+ * 只支持环形缓存区接收方式.
+ *
+ * @param[in]  com   串口号
+ * @param[out] p_buf 帧缓存区
+ * @param[in]  max   帧缓存区大小
+ * @param[in]  delim 分隔符
+ *
+ * @return 成功:返回帧长度, 超时返回0,
+ *         失败:返回负数(错误码), max字节内(或缓存区满时)没有分隔符
+ *         返回-LM_EFULL, 这些数据被丢弃.
+ */
+extern int lm_serial_read_until (int com, void *p_buf, size_t max, uint8_t delim);
+
+/**
+ * @brief 读取一帧, 帧长由帧头中的长度字段决定
+ *
+ * 收齐帧头后解析长度字段, 在接收环形缓存区中等待整帧到达后一次取出.
+ *
+ * @param[in]  com   串口号
+ * @param[out] p_buf 帧缓存区
+ * @param[in]  max   帧缓存区大小
+ * @param[in]  p_fmt 帧格式
+ *
+ * @return 成功:返回帧长度, 超时返回0,
+ *         失败:返回负数(错误码), 帧长非法或超过max时返回-LM_EFULL,
+ *         缓存区中的数据被丢弃(无法确定帧边界).
+ */
+extern int lm_serial_read_frame (int                              com,
+                                 void                            *p_buf,
+                                 size_t                           max,
+                                 const struct lm_serial_frame_fmt *p_fmt);
+
 /**
  * @brief 注册串口驱动
  */
 extern int lm_serial_register (struct lm_serial_port *p_spi);
 
+/**
+ * @brief 注销串口驱动, 释放lm_serial_register()创建的锁和信号量
+ *
+ * 调用者保证没有任务正在使用该串口, 底层驱动的中断和接收任务已经停止
+ *
+ * @param[in] com 串口号
+ *
+ * @return LM_OK 成功, -LM_EINVAL 串口号非法, -LM_ENODEV 串口未注册
+ */
+extern int lm_serial_unregister (int com);
+
 #endif /* __LM_SERIAL_H */
 
 /* end of file */
@@ -0,0 +1,141 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_serial_mux.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 串口逻辑通道复用模块
+*******************************************************************************/
+
+#ifndef __LM_SERIAL_MUX_H
+#define __LM_SERIAL_MUX_H
+
+#include "lm_serial.h"
+
+LM_BEGIN_EXTERN_C
+
+/*
+ * 在一个物理串口上复用多个逻辑通道, 每个通道注册为一个虚拟串口,
+ * 上层(shell, ulog, 遥测等)照常用lm_serial_read()/lm_serial_write()访问.
+ *
+ * 帧格式: COBS(通道号 | 数据 | CRC-8) 0x00
+ *   - COBS编码后帧内没有0x00, 0x00只作为帧结束符, 出错后在下一个0x00处重新同步
+ *   - CRC-8多项式0x07, 覆盖通道号和数据
+ *   - 发送时按LM_SERIAL_MUX_MTU切分, 各通道的帧在物理串口上交错发送,
+ *     大量遥测数据不会长时间占住串口, shell仍然能及时响应
+ *
+ * 主机端使用tools/lm_serial_mux.py解复用, 每个通道对应一个伪终端.
+ */
+
+/* 每帧最多携带的数据长度 */
+#ifndef LM_SERIAL_MUX_MTU
+#define LM_SERIAL_MUX_MTU               64
+#endif
+
+/* 最多的逻辑通道数 */
+#ifndef LM_SERIAL_MUX_CHAN_MAX
+#define LM_SERIAL_MUX_CHAN_MAX          4
+#endif
+
+/* 解复用任务的栈大小和优先级 */
+#ifndef LM_SERIAL_MUX_TASK_STACK
+#define LM_SERIAL_MUX_TASK_STACK        256
+#endif
+
+#ifndef LM_SERIAL_MUX_TASK_PRIO
+#define LM_SERIAL_MUX_TASK_PRIO         (configMAX_PRIORITIES - 2)
+#endif
+
+/* 物理串口的码间超时(ms), 收到半帧时按该时间返回 */
+#ifndef LM_SERIAL_MUX_IDLE_MS
+#define LM_SERIAL_MUX_IDLE_MS           2
+#endif
+
+/* 编码前的最大帧长: 通道号 + 数据 + CRC */
+#define LM_SERIAL_MUX_RAW_MAX           (LM_SERIAL_MUX_MTU + 2)
+
+/* 编码后的最大帧长(不含结束符) */
+#define LM_SERIAL_MUX_FRAME_MAX         (LM_SERIAL_MUX_RAW_MAX + \
+                                         LM_SERIAL_MUX_RAW_MAX / 254 + 1)
+
+struct lm_serial_mux;
+
+/**
+ * @brief 逻辑通道(虚拟串口)
+ */
+struct lm_serial_mux_chan {
+    struct lm_serial_port       port;               /* 虚拟串口, 必须是第一个成员 */
+    struct lm_serial_mux       *p_mux;
+    uint8_t                     chan;               /* 通道号 */
+};
+
+/**
+ * @brief 解复用统计
+ */
+struct lm_serial_mux_stat {
+    uint32_t                    frames;             /* 正确的帧数 */
+    uint32_t                    crc_errors;         /* CRC或编码错误 */
+    uint32_t                    unknown_chan;       /* 未注册通道的帧 */
+    uint32_t                    overflows;          /* 帧过长 */
+};
+
+/**
+ * @brief 复用器
+ */
+struct lm_serial_mux {
+    int                         com;                /* 物理串口号 */
+    struct lm_serial_mux_chan  *chans[LM_SERIAL_MUX_CHAN_MAX];
+
+    uint8_t                     rx_frame[LM_SERIAL_MUX_FRAME_MAX];
+    uint16_t                    rx_len;
+    uint8_t                     rx_drop;            /* 帧过长, 丢弃到下一个结束符 */
+
+    struct lm_serial_mux_stat   stat;
+};
+
+/**
+ * @brief 初始化复用器并启动解复用任务
+ *
+ * 必须在lm_serial_mux_add()之前调用, 并且每个复用器只调用一次:
+ * 初始化会清零整个复用器, 之前添加的通道会丢失. 失败时物理串口
+ * 恢复原来的超时配置
+ *
+ * @param[in] p_mux 复用器
+ * @param[in] com   物理串口号(已注册)
+ *
+ * @return LM_OK 成功, 其他 失败
+ */
+extern int lm_serial_mux_init (struct lm_serial_mux *p_mux, int com);
+
+/**
+ * @brief 添加逻辑通道, 注册为虚拟串口
+ *
+ * 在lm_serial_mux_init()成功之后调用
+ *
+ * @param[in] p_mux    复用器
+ * @param[in] p_chan   逻辑通道
+ * @param[in] chan     通道号(0 ~ LM_SERIAL_MUX_CHAN_MAX - 1)
+ * @param[in] vcom     虚拟串口号(未被物理串口占用的COM号)
+ * @param[in] recv_buf 虚拟串口的接收缓存区
+ * @param[in] buf_size 接收缓存区大小
+ *
+ * @return LM_OK 成功, 其他 失败
+ */
+extern int lm_serial_mux_add (struct lm_serial_mux      *p_mux,
+                              struct lm_serial_mux_chan *p_chan,
+                              uint8_t                    chan,
+                              int                        vcom,
+                              uint8_t                   *recv_buf,
+                              uint32_t                   buf_size);
+
+LM_END_EXTERN_C
+
+#endif /* __LM_SERIAL_MUX_H */
+
+/* end of file */
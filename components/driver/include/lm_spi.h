@@ -9,6 +9,46 @@
 
 #define     SPI_NAME_SIZE               10
 
+/*
+ * 合并传输的最大总长度, 消息中相邻的多个短传输(如命令 + 地址 + 数据)
+ * 合并成一次控制器操作, 为0时不合并
+ */
+#ifndef LM_SPI_COALESCE_MAX
+#define LM_SPI_COALESCE_MAX         32
+#endif
+
+/* SPI控制器的最大个数, 总线ID取值范围为0 ~ LM_SPI_BUS_MAX - 1 */
+#ifndef LM_SPI_BUS_MAX
+#define LM_SPI_BUS_MAX              4
+#endif
+
+/* 每个设备缓存的控制器配置大小(字) */
+#ifndef LM_SPI_CTRL_CFG_WORDS
+#define LM_SPI_CTRL_CFG_WORDS       2
+#endif
+
+/*
+ * DMA缓存区对齐(缓存行大小), 地址按此对齐的发送缓存区, 地址和长度都按此
+ * 对齐的接收缓存区才直接用于DMA
+ */
+#ifndef LM_SPI_DMA_ALIGN
+#define LM_SPI_DMA_ALIGN            32
+#endif
+
+/* 默认的DMA传输门限, 小于该长度的传输使用PIO(pfunc_transfer) */
+#ifndef LM_SPI_DMA_THRESHOLD
+#define LM_SPI_DMA_THRESHOLD        32
+#endif
+
+/* 弹跳缓存区个数(小于32)和大小(所有控制器共用), 个数为0时不使用弹跳缓存区 */
+#ifndef LM_SPI_DMA_BOUNCE_NUM
+#define LM_SPI_DMA_BOUNCE_NUM       2
+#endif
+
+#ifndef LM_SPI_DMA_BOUNCE_SIZE
+#define LM_SPI_DMA_BOUNCE_SIZE      512
+#endif
+
 typedef struct lm_spi_dev {
     uint8_t                     bus_id;
     uint8_t                     bits_per_word;
@@ -42,6 +82,16 @@ typedef struct lm_spi_dev {
 
     const void                  *cs_gpio;           /* 片选 */
 
+    /* 设备所在的控制器, lm_spi_setup()时解析 */
+    struct lm_spi_master        *p_master;
+
+    /*
+     * 控制器为该设备预先计算的配置(如寄存器值), 由pfunc_setup填写,
+     * 切换到该设备时由pfunc_apply写入控制器
+     */
+    uint32_t                    ctrl_cfg[LM_SPI_CTRL_CFG_WORDS];
+    uint8_t                     cfg_dirty;          /* 配置已修改, 下次传输前需要重新写入 */
+
 }lm_spi_dev_t;
 
 typedef struct lm_spi_master lm_spi_master_t;
@@ -76,6 +126,11 @@ typedef struct lm_spi_transfer{
 
     uint8_t     bits_per_word;
 
+    /*
+     * 传输后的延时(us), 在任务中忙等待. 带延时的传输不合并, 不使用DMA;
+     * 消息泵在中断中运行(前一个传输在中断中完成或在中断中提交消息)
+     * 或驱动在中断中完成该传输时, 消息以-LM_ENOTSUP结束
+     */
     uint16_t    delay_usece;
 
     uint32_t    speed_hz;             /* 传输速度,使用默认速度时设置为0 */
@@ -111,11 +166,31 @@ typedef struct lm_spi_message {
 
 /**
  * @brief spi master服务函数
+ *
+ * 驱动返回-LM_EINPROGRESS后, 消息泵在传输完成中断中(lm_spi_transfer_done())
+ * 继续传输后续的传输和消息, 此时切换设备的pfunc_setup/pfunc_apply,
+ * pfunc_transfer, pfunc_transfer_dma和pfunc_set_cs都在中断中被调用,
+ * 必须可以在中断中调用并且不能阻塞(不能获取互斥量, 等待信号量或任务延时).
+ * 做不到的驱动只能同步完成传输(总是返回LM_OK), 消息泵不会进入中断.
  */
 typedef struct lm_spi_funcs{
+    /*
+     * 设置设备. 提供pfunc_apply时只计算配置存入p_spi->ctrl_cfg,
+     * 不访问控制器; 否则直接配置控制器, 在切换设备时被再次调用
+     */
     int (*pfunc_setup)(lm_spi_master_t *p_master,
                        lm_spi_dev_t    *p_spi);
 
+    /* 切换到设备p_spi, 把ctrl_cfg写入控制器(可选) */
+    int (*pfunc_apply)(lm_spi_master_t *p_master,
+                       lm_spi_dev_t    *p_spi);
+
+    /*
+     * 传输完成返回LM_OK; 在中断/DMA中完成时返回-LM_EINPROGRESS,
+     * 完成后在中断中调用lm_spi_transfer_done().
+     * p_txbuf为NULL(只接收)时应发送0xff: 合并传输(LM_SPI_COALESCE_MAX)
+     * 中只接收的段固定以0xff填充, 驱动发送其他值时合并前后线上的数据不同
+     */
     int (*pfunc_transfer)(lm_spi_master_t   *p_master,
                           lm_spi_dev_t      *p_spi,
                           lm_spi_transfer_t *p_trans);
@@ -123,6 +198,21 @@ typedef struct lm_spi_funcs{
     int (*pfunc_set_cs) (lm_spi_master_t     *p_master,
                          uint8_t              enable);
 
+    /*
+     * DMA传输(可选), 返回值同pfunc_transfer. 传入的缓存区地址已经按
+     * LM_SPI_DMA_ALIGN对齐(接收缓存区的长度也对齐或者是弹跳缓存区),
+     * 驱动负责缓存的清理和无效化.
+     * p_trans是框架内部的副本, 不能访问其transfer_list
+     */
+    int (*pfunc_transfer_dma)(lm_spi_master_t   *p_master,
+                              lm_spi_dev_t      *p_spi,
+                              lm_spi_transfer_t *p_trans);
+
+    /* 缓存区能否用于DMA(可选, 如排除TCM等DMA不能访问的区域), 默认只检查对齐 */
+    bool (*pfunc_can_dma)(lm_spi_master_t *p_master,
+                          const void      *p_buf,
+                          size_t           len);
+
 }lm_spi_funcs_t;
 
 
@@ -131,14 +221,40 @@ typedef struct lm_spi_funcs{
  * @brief SPI 控制器
  */
 struct lm_spi_master {
-    struct lm_list_head         list;
-
     int                         bus_id;
 
-    /* 指向当前设备的指针 */
+    /* 指向当前设备的指针(控制器中生效的是该设备的配置) */
     lm_spi_dev_t               *p_spi;
 
     lm_mutex_t                  bus_lock_mutex;
+    lm_task_handle_t            bus_owner;          /* lm_spi_bus_lock()独占总线的任务 */
+
+    /* 同步传输等待消息完成 */
+    lm_semb_t                   sync_semb;
+
+    /* 消息队列, 由lm_spi_async()加入, 消息泵依次传输 */
+    struct lm_list_head         queue;
+    lm_spi_message_t           *p_cur_msg;          /* 正在传输的消息 */
+    struct lm_spi_transfer     *p_cur_xfer;         /* 正在传输的传输 */
+    struct lm_spi_transfer     *p_run_xfer;         /* 实际交给控制器的传输 */
+    uint8_t                     busy;               /* 消息泵正在运行 */
+    uint8_t                     in_isr;             /* 消息泵在lm_spi_transfer_done()中运行 */
+    uint8_t                     keep_cs;            /* 消息结束后保持片选 */
+
+    /* DMA传输, 长度不小于dma_threshold时使用, 为0时使用LM_SPI_DMA_THRESHOLD */
+    size_t                      dma_threshold;
+    lm_spi_transfer_t           dma_xfer;           /* 正在进行的DMA传输(替换了缓存区的副本) */
+    uint8_t                    *p_dma_tx_bounce;    /* 使用的弹跳缓存区 */
+    uint8_t                    *p_dma_rx_bounce;
+    uint8_t                     dma_mapped;         /* 当前传输使用DMA */
+
+#if LM_SPI_COALESCE_MAX
+    /* 合并传输 */
+    lm_spi_transfer_t           merge_xfer;
+    uint8_t                     merge_tx[LM_SPI_COALESCE_MAX] __aligned(LM_SPI_DMA_ALIGN);
+    uint8_t                     merge_rx[LM_SPI_COALESCE_MAX] __aligned(LM_SPI_DMA_ALIGN);
+    uint8_t                     merge_cnt;          /* 合并的传输个数, 0表示没有合并 */
+#endif
 
     /* 驱动私有数据，由对应的驱动程序分配内存 */
     void                       *p_driver_data;
@@ -179,6 +295,7 @@ lm_spi_dev_init (lm_spi_dev_t       *p_spi,
     p_spi->max_speed_hz  = speed_hz;
     p_spi->flags         = flags;
     p_spi->cs_gpio       = cs_gpio;
+    p_spi->p_master      = NULL;
 }
 
 /**
@@ -228,12 +345,71 @@ lm_spi_message_add_tail (struct lm_spi_transfer *t, struct lm_spi_message *m)
  */
 extern int lm_spi_setup (lm_spi_dev_t *p_spi);
 
+/**
+ * @brief 独占总线, 在lm_spi_bus_unlock()之前其他任务不能传输
+ *
+ * 用于需要连续传输多个消息的操作(如写使能 + 编程 + 读状态).
+ * 持有总线的任务可以继续调用lm_spi_sync()/lm_spi_async(),
+ * 其他任务的lm_spi_sync()阻塞, lm_spi_async()返回-LM_EBUSY.
+ *
+ * @param[in] p_spi spi设备
+ *
+ * @return  LM_OK     成功
+ *          其他      失败
+ */
+extern int lm_spi_bus_lock (lm_spi_dev_t *p_spi);
+
+/**
+ * @brief 释放总线
+ *
+ * @param[in] p_spi spi设备
+ *
+ * @return  LM_OK     成功
+ *          其他      失败
+ */
+extern int lm_spi_bus_unlock (lm_spi_dev_t *p_spi);
+
 /**
  * @brief spi 同步传输
  */
 extern int lm_spi_sync (lm_spi_dev_t     *p_spi,
                         lm_spi_message_t *p_msg);
 
+/**
+ * @brief spi 异步传输
+ *
+ * 消息加入控制器的队列后立即返回, 传输完成后调用p_msg->pfunc_complete(p_arg),
+ * 结果保存在p_msg->status中. 总线空闲时在调用者上下文中开始传输,
+ * 之后的消息由传输完成中断接着传输, 回调可能在中断中被调用.
+ * 消息和其中的传输在完成回调之前必须保持有效.
+ *
+ * 其他任务通过lm_spi_bus_lock()独占总线期间消息不会排队等待, 直接返回
+ * -LM_EBUSY, 调用者在总线释放后重新提交. 中断中调用时只要总线被独占
+ * 就返回-LM_EBUSY.
+ *
+ * @param[in] p_spi spi设备
+ * @param[in] p_msg 消息
+ *
+ * @return  LM_OK     成功加入队列
+ *          -LM_EBUSY 总线被其他任务独占, 消息没有加入队列
+ *          其他      失败
+ */
+extern int lm_spi_async (lm_spi_dev_t     *p_spi,
+                         lm_spi_message_t *p_msg);
+
+/**
+ * @brief 一次传输完成, 由控制器驱动在传输完成中断中调用
+ *
+ * 仅用于pfunc_transfer返回-LM_EINPROGRESS的传输, 继续传输下一个传输或消息.
+ * 后续传输的PIO, 设备切换和片选都在本中断中进行, 驱动的服务函数需满足
+ * lm_spi_funcs_t中的中断上下文要求. 不在中断中忙等待, 带delay_usece的
+ * 传输在这里以-LM_ENOTSUP结束所在的消息.
+ *
+ * @param[in] p_master 控制器
+ * @param[in] status   传输结果
+ */
+extern void lm_spi_transfer_done (lm_spi_master_t *p_master, int status);
+
 /**
  * @brief 先写后读
  *
@@ -1,5 +1,6 @@
 #include "lmiracle.h"
 #include "lm_serial.h"
+#include "lm_atomic.h"
 
 /* 链表头 */
 static LIST_HEAD(__g_spi_list);
@@ -11,16 +12,190 @@ static struct lm_serial_port *__gp_serial[COM_MUX] = {NULL};
 const static struct lm_serial_info __g_serial_info_default =
                     LM_SERIAL_INFO_DEFAULT;
 
-int lm_serial_get_info (int com, struct lm_serial_info *p_info)
+#if LM_SERIAL_PERF_ENABLED
+
+#define __serial_perf_inc(p_serial, member)       ((p_serial)->perf.member++)
+#define __serial_perf_add(p_serial, member, n)    ((p_serial)->perf.member += (n))
+
+/*
+ * 获取锁, 记录等待时间
+ */
+static inline void __serial_lock (struct lm_serial_port *p_serial, lm_mutex_t *p_mutex)
 {
-    int ret = LM_OK;
+    lm_tick_t start = lm_sys_get_tick();
+    uint32_t  wait;
 
-    struct lm_serial_port *p_serial;
+    lm_mutex_lock(p_mutex, LM_SEM_WAIT_FOREVER);
 
-    if (lm_is_int_context()) {
+    wait = lm_tick_to_ms(lm_sys_get_tick() - start);
+    p_serial->perf.lock_wait_total += wait;
+    if (wait > p_serial->perf.lock_wait_max) {
+        p_serial->perf.lock_wait_max = wait;
+    }
+}
+
+/*
+ * 同步写完成, 按耗时(us)的2的幂分档统计, 需在释放写锁之前调用
+ */
+static inline void __serial_perf_write_done (struct lm_serial_port *p_serial,
+                                             size_t                 len,
+                                             uint32_t               stamp)
+{
+    uint32_t us  = lm_us_elapsed(stamp);
+    uint32_t bin = 0;
+
+    while ((us >> bin) && (bin < LM_SERIAL_PERF_HIST_BINS - 1)) {
+        bin++;
+    }
+
+    p_serial->perf.writes++;
+    p_serial->perf.tx_bytes += len;
+    p_serial->perf.write_hist[bin]++;
+    if (us > p_serial->perf.write_max_us) {
+        p_serial->perf.write_max_us = us;
+    }
+}
+
+#else
+
+#define __serial_perf_inc(p_serial, member)
+#define __serial_perf_add(p_serial, member, n)
+#define __serial_perf_write_done(p_serial, len, stamp) ((void)(stamp))
+#define __serial_lock(p_serial, p_mutex) \
+        lm_mutex_lock(p_mutex, LM_SEM_WAIT_FOREVER)
+
+#endif
+
+/* 接收任务通知值 */
+#define __SERIAL_RX_EVT_LEVEL       0x01        /* 数据量达到等待的字节数 */
+#define __SERIAL_RX_EVT_DELIM       0x02        /* 收到分隔符 */
+#define __SERIAL_RX_EVT_IDLE        0x04        /* 接收空闲 */
+#define __SERIAL_RX_EVT_SELECT      0x08        /* 多串口等待的串口有数据 */
+#define __SERIAL_RX_EVT_ALL         (__SERIAL_RX_EVT_LEVEL | \
+                                     __SERIAL_RX_EVT_DELIM | \
+                                     __SERIAL_RX_EVT_IDLE)
+
+/*
+ * 计算一个字符的传输时间
+ */
+uint32_t lm_serial_char_time_ns (const struct lm_serial_config *p_config)
+{
+    uint32_t half_bits;
+
+    if ((p_config == NULL) || (p_config->baud_rate == 0)) {
+        return 0;
+    }
+
+    /* 以半位计算, 1.5个停止位也能表示 */
+    half_bits  = 2 * (1 + p_config->data_bits);
+    half_bits += (p_config->parity != LM_SERIAL_PARITY_NONE) ? 2 : 0;
+
+    switch (p_config->stop_bits) {
+    case LM_SERIAL_STOP_BITS_1_5:
+        half_bits += 3;
+        break;
+    case LM_SERIAL_STOP_BITS_2:
+    case LM_SERIAL_STOP_BITS_3:
+        half_bits += 4;
+        break;
+    default:
+        half_bits += 2;
+        break;
+    }
+
+    return (uint32_t)((uint64_t)half_bits * 500000000UL / p_config->baud_rate);
+}
+
+/*
+ * 按新配置设置硬件接收超时并计算空闲超时, 在wr_mutex保护下调用
+ *
+ * 结果只写入*p_idle_ms和*p_hw_idle, 由__serial_info_publish()和配置一起
+ * 发布. 硬件接收超时立即生效, 正在进行的读仍使用开始时的快照, 硬件
+ * 不再上报空闲时由快照中的软件空闲超时结束.
+ * 没有硬件接收超时且调用者没有用LM_SERIAL_IDLE_SW_OK允许软件方式时
+ * 返回-LM_ENOTSUP
+ */
+static int __serial_idle_calc (struct lm_serial_port       *p_serial,
+                               const struct lm_serial_info *p_info,
+                               uint32_t                    *p_idle_ms,
+                               uint8_t                     *p_hw_idle)
+{
+    uint32_t chars = LM_SERIAL_IDLE_CHARS(p_info->idle_chars);
+    uint64_t ns;
+
+    *p_idle_ms = p_info->idle_timeout;
+    *p_hw_idle = 0;
+
+    if (p_serial->p_ops->pfunc_set_rx_timeout) {
+        if ((p_serial->p_ops->pfunc_set_rx_timeout(p_serial, chars) == LM_OK) &&
+            (chars != 0)) {
+            *p_hw_idle = 1;
+        }
+    }
+
+    if (chars == 0) {
+        return LM_OK;
+    }
+
+    if (!*p_hw_idle && !(p_info->idle_chars & LM_SERIAL_IDLE_SW_OK)) {
         return -LM_ENOTSUP;
     }
 
+    /*
+     * 软件方式只能以tick为单位等待, 向上取整, 至少1ms, 没有亚毫秒的实现.
+     * 硬件方式下这个值只作为后备, 正常情况下由接收超时中断结束读
+     */
+    ns = (uint64_t)chars * lm_serial_char_time_ns(&p_info->config);
+    *p_idle_ms = (uint32_t)((ns + 999999) / 1000000);
+    if (*p_idle_ms == 0) {
+        *p_idle_ms = 1;
+    }
+
+    return LM_OK;
+}
+
+/*
+ * 新配置不能生效时恢复硬件上原来的配置和接收超时, 在wr_mutex保护下调用
+ */
+static void __serial_idle_restore (struct lm_serial_port *p_serial, bool config)
+{
+    const struct lm_serial_info *p_old = &p_serial->serial_info;
+
+    if (config && p_serial->p_ops->pfunc_set_config) {
+        p_serial->p_ops->pfunc_set_config(p_serial, &p_old->config);
+    }
+
+    if (p_serial->p_ops->pfunc_set_rx_timeout) {
+        p_serial->p_ops->pfunc_set_rx_timeout(p_serial,
+                                              p_serial->rx_hw_idle ?
+                                              LM_SERIAL_IDLE_CHARS(p_old->idle_chars) : 0);
+    }
+}
+
+/*
+ * 读开始时取得超时配置的快照, 读过程中修改配置不影响这次读
+ */
+static void __serial_rx_timeouts (struct lm_serial_port *p_serial,
+                                  uint32_t              *p_total,
+                                  uint32_t              *p_idle_ms,
+                                  uint8_t               *p_hw_idle)
+{
+    lm_critical_enter();
+    *p_total = p_serial->serial_info.read_timeout;
+    if (p_idle_ms) {
+        *p_idle_ms = p_serial->rx_idle_ms;
+    }
+    if (p_hw_idle) {
+        *p_hw_idle = p_serial->rx_hw_idle;
+    }
+    lm_critical_exit();
+}
+
+int lm_serial_get_info (int com, struct lm_serial_info *p_info)
+{
+    struct lm_serial_port *p_serial;
+    uint32_t               seq;
+
     if ((com >= COM_MUX) || (p_info == NULL)) {
         return -LM_EINVAL;
     }
@@ -30,16 +205,35 @@ int lm_serial_get_info (int com, struct lm_serial_info *p_info)
         return -LM_ENODEV;
     }
 
-    /* 获取读写锁 */
-    lm_mutex_lock(&p_serial->wr_mutex, LM_SEM_WAIT_FOREVER);
-    lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
-
-    memcpy(p_info, &p_serial->serial_info, sizeof(*p_info));
+    /* 读取过程中配置被修改则重读 */
+    do {
+        seq = lm_atomic_load_acquire(&p_serial->info_seq);
+        memcpy(p_info, &p_serial->serial_info, sizeof(*p_info));
+        lm_atomic_fence_acquire();
+    } while ((seq & 1) || (lm_atomic_load_relaxed(&p_serial->info_seq) != seq));
 
-    lm_mutex_unlock(&p_serial->ro_mutex);
-    lm_mutex_unlock(&p_serial->wr_mutex);
+    return LM_OK;
+}
 
-    return ret;
+/*
+ * 发布新配置和由它算出的空闲超时, 在wr_mutex保护下调用
+ *
+ * 在临界区内更新, 同一个核上的读者不会看到更新到一半的配置,
+ * 顺序锁保证其他上下文(如另一个核)读到的快照一致
+ */
+static void __serial_info_publish (struct lm_serial_port       *p_serial,
+                                   const struct lm_serial_info *p_info,
+                                   uint32_t                     idle_ms,
+                                   uint8_t                      hw_idle)
+{
+    lm_critical_enter();
+    lm_atomic_store_relaxed(&p_serial->info_seq, p_serial->info_seq + 1);
+    lm_atomic_fence_release();
+    memcpy(&p_serial->serial_info, p_info, sizeof(*p_info));
+    p_serial->rx_idle_ms = idle_ms;
+    p_serial->rx_hw_idle = hw_idle;
+    lm_atomic_store_release(&p_serial->info_seq, p_serial->info_seq + 1);
+    lm_critical_exit();
 }
 
 /*
@@ -47,8 +241,11 @@ int lm_serial_get_info (int com, struct lm_serial_info *p_info)
  */
 int lm_serial_set_info (int com, const struct lm_serial_info *p_info)
 {
-    int ret;
+    int ret = LM_OK;
     struct lm_serial_port *p_serial;
+    bool mode_change;
+    uint32_t idle_ms;
+    uint8_t hw_idle;
 
     if (lm_is_int_context()) {
         return -LM_ENOTSUP;
@@ -63,32 +260,193 @@ int lm_serial_set_info (int com, const struct lm_serial_info *p_info)
         return -LM_ENODEV;
     }
 
-    /* 获取读写锁 */
+    /*
+     * 只与写互斥, 不等待阻塞中的读(读超时可能是永久);
+     * 切换接收方式会改变读的路径, 此时才需要等待读结束
+     */
     lm_mutex_lock(&p_serial->wr_mutex, LM_SEM_WAIT_FOREVER);
-    lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
+    mode_change = (p_info->config.transmit_type !=
+                   p_serial->serial_info.config.transmit_type);
+    if (mode_change) {
+        lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
+    }
 
     if (p_info->config.transmit_type) {
 //        if (p_serial->p_ops->pfunc_set_config_dma) {
 //            ret = p_serial->p_ops->pfunc_set_config_dma(p_serial);
 //            if (!ret) {
-                memcpy(&p_serial->serial_info, p_info, sizeof(*p_info));
+                ret = __serial_idle_calc(p_serial, p_info, &idle_ms, &hw_idle);
+                if (!ret) {
+                    __serial_info_publish(p_serial, p_info, idle_ms, hw_idle);
+                } else {
+                    __serial_idle_restore(p_serial, false);
+                }
 //            }
 //        }
     } else {
+        /* 没有硬件配置的驱动(如虚拟串口), 超时等软件参数仍然要生效 */
         if (p_serial->p_ops->pfunc_set_config) {
             ret = p_serial->p_ops->pfunc_set_config(p_serial, &p_info->config);
+        }
+        if (!ret) {
+            ret = __serial_idle_calc(p_serial, p_info, &idle_ms, &hw_idle);
             if (!ret) {
-                memcpy(&p_serial->serial_info, p_info, sizeof(*p_info));
+                __serial_info_publish(p_serial, p_info, idle_ms, hw_idle);
+            } else {
+                __serial_idle_restore(p_serial, true);
             }
         }
     }
 
-    lm_mutex_unlock(&p_serial->ro_mutex);
+    if (mode_change) {
+        lm_mutex_unlock(&p_serial->ro_mutex);
+    }
     lm_mutex_unlock(&p_serial->wr_mutex);
 
     return ret;
 }
 
+/*
+ * 串口读(任务通知方式), 在ro_mutex保护下调用
+ */
+static size_t __serial_read_notify (struct lm_serial_port *p_serial,
+                                    uint8_t               *p_buffer,
+                                    size_t                 size)
+{
+    uint32_t total_time, timeout, least_timeout, use_time;
+    uint32_t start_tick, level, events;
+    size_t   idx = 0, len, want;
+
+    __serial_rx_timeouts(p_serial, &total_time, &least_timeout, NULL);
+    timeout = total_time;
+    level   = p_serial->rx_trigger.level;
+
+    if (total_time < least_timeout) {
+        least_timeout = total_time;
+    }
+
+    /* 丢弃上一次读留下的通知, 只清除串口使用的位 */
+    lm_task_notify_clear(__SERIAL_RX_EVT_ALL);
+
+    start_tick = lm_sys_get_tick();
+
+    while (size) {
+
+        /*
+         * 先登记等待条件再检查缓存区, 检查之后到达的数据一定能看到
+         * rx_waiter并发送通知(中断与任务在同一个核上, 只需约束编译器顺序)
+         */
+        want = ((level != 0) && (level < size)) ? level : size;
+        if (want > lm_ringbuf_get_size(&p_serial->rbuf)) {
+            /* 缓存区满时也要唤醒, 否则数据会一直堆积 */
+            want = lm_ringbuf_get_size(&p_serial->rbuf);
+        }
+        p_serial->rx_want = want;
+        lm_atomic_store_release(&p_serial->rx_waiter, lm_task_self());
+
+        events = __SERIAL_RX_EVT_LEVEL;
+        if (lm_ringbuf_data_len(&p_serial->rbuf) < p_serial->rx_want) {
+            if (lm_task_notify_wait(__SERIAL_RX_EVT_ALL, &events, timeout) != LM_OK) {
+                events = 0;
+            } else {
+                __serial_perf_inc(p_serial, read_wakeups);
+            }
+        }
+        lm_atomic_store_release(&p_serial->rx_waiter, NULL);
+
+        len   = lm_ringbuf_get(&p_serial->rbuf, &p_buffer[idx],
+                               (size > 0xFFFF) ? 0xFFFF : size);
+        idx  += len;
+        size -= len;
+
+        /* 超时, 或者一帧已经结束 */
+        if ((events == 0) ||
+            ((events & (__SERIAL_RX_EVT_DELIM | __SERIAL_RX_EVT_IDLE)) && idx)) {
+            break;
+        }
+
+        if (total_time != (uint32_t)-1) {
+            use_time = lm_tick_to_ms(lm_sys_get_tick() - start_tick);
+            if (use_time > total_time) {
+                break;
+            }
+            timeout = (total_time - use_time > least_timeout) ?
+                      least_timeout : total_time - use_time;
+        } else {
+            timeout = least_timeout;
+        }
+    }
+
+    return idx;
+}
+
+/*
+ * DMA多缓存接收: 借用一块已接收的数据, 在ro_mutex保护下调用
+ */
+static int __serial_block_borrow (struct lm_serial_port  *p_serial,
+                                  const uint8_t         **pp_data,
+                                  uint32_t                timeout)
+{
+    uint32_t borrow = p_serial->rx_block_borrow;
+    uint32_t idx;
+
+    /* 驱动每填满一块给一次信号量, 这里循环检查避免漏掉连续填满的块 */
+    while (borrow == lm_atomic_load_acquire(&p_serial->rx_block_head)) {
+        if (lm_semb_take(&p_serial->ro_sync_semb, timeout) != LM_OK) {
+            return -LM_ETIMEOUT;
+        }
+        __serial_perf_inc(p_serial, read_wakeups);
+    }
+
+    idx      = borrow % p_serial->rx_block_num;
+    *pp_data = &p_serial->recv_buf[idx * p_serial->rx_block_size];
+    p_serial->rx_block_borrow = borrow + 1;
+
+    return p_serial->rx_block_len[idx];
+}
+
+/*
+ * DMA多缓存接收: 归还最早借用的块, 在ro_mutex保护下调用
+ */
+static int __serial_block_return (struct lm_serial_port *p_serial)
+{
+    uint32_t tail = p_serial->rx_block_tail;
+
+    if (tail == p_serial->rx_block_borrow) {
+        return -LM_EINVAL;
+    }
+
+    lm_atomic_store_release(&p_serial->rx_block_tail, tail + 1);
+
+    return LM_OK;
+}
+
+/*
+ * 串口读(DMA多缓存接收方式), 在ro_mutex保护下调用
+ */
+static size_t __serial_read_block (struct lm_serial_port *p_serial,
+                                   uint8_t               *p_buffer,
+                                   size_t                 size)
+{
+    const uint8_t *p_data;
+    int            len;
+
+    len = __serial_block_borrow(p_serial, &p_data, LM_SEM_WAIT_FOREVER);
+    if (len < 0) {
+        return 0;
+    }
+
+    /* 拷贝期间驱动写入的是其他块, 不会覆盖正在读的数据 */
+    if ((size_t)len > size) {
+        len = size;
+    }
+    memcpy(p_buffer, p_data, len);
+
+    __serial_block_return(p_serial);
+
+    return len;
+}
+
 /*
  * 串口读
  */
@@ -100,7 +458,8 @@ int lm_serial_read (int com, void *p_buf, size_t size)
     uint32_t  start_tick = 0;
     size_t    idx        = 0;
     uint32_t  len        = 0;
-    uint8_t *p_buffer;
+    uint8_t  *p_buffer;
+    uint8_t   hw_idle    = 0;
 
     /* 剩下的全局超时 */
     uint32_t  remain_total_timeout = 0;
@@ -122,33 +481,41 @@ int lm_serial_read (int com, void *p_buf, size_t size)
     }
 
     p_buffer = (uint8_t *)p_buf;
-    lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
-    if(!p_serial->serial_info.config.transmit_type) {
+    __serial_lock(p_serial, &p_serial->ro_mutex);
+    if (!p_serial->serial_info.config.transmit_type && p_serial->rx_notify) {
+        idx = __serial_read_notify(p_serial, p_buffer, size);
+    } else if(!p_serial->serial_info.config.transmit_type) {
 
-        total_time = p_serial->serial_info.read_timeout;
-        timeout    = total_time;
+        __serial_rx_timeouts(p_serial, &total_time, &least_timeout, &hw_idle);
+        timeout = total_time;
 
-        if (total_time > p_serial->serial_info.idle_timeout) {
-            least_timeout = p_serial->serial_info.idle_timeout;
-        } else {
+        if (total_time < least_timeout) {
             least_timeout = total_time;
         }
 
         /* 获取互斥量后才开始记录 超时时间 */
         start_tick = lm_sys_get_tick();
+        p_serial->rx_idle_flag = 0;
 
         while (size) {
 
             if (lm_semb_take(&p_serial->ro_sync_semb, timeout) != LM_OK) {
                 /* 接收超时 */
-                lm_mutex_unlock(&p_serial->ro_mutex);
-                return idx;
+                break;
             }
+            __serial_perf_inc(p_serial, read_wakeups);
 
             len      =  lm_ringbuf_get(&p_serial->rbuf, &p_buffer[idx], size);
             idx      += len;
             size     -= len;
 
+            /* 硬件接收超时表示一帧已经结束 */
+            if (hw_idle && p_serial->rx_idle_flag && idx &&
+                !lm_ringbuf_data_len(&p_serial->rbuf)) {
+                p_serial->rx_idle_flag = 0;
+                break;
+            }
+
             /*
              * 如果没有读完,下次进来可以直接读取
              */
@@ -163,8 +530,7 @@ int lm_serial_read (int com, void *p_buf, size_t size)
 
                 if (tmp_use_time > total_time) {
                     /* 总超时已到 */
-                    lm_mutex_unlock(&p_serial->ro_mutex);
-                    return idx;
+                    break;
                 } else {
                     /* 剩下的全局超时时间  */
                     remain_total_timeout = total_time - tmp_use_time;
@@ -184,6 +550,8 @@ int lm_serial_read (int com, void *p_buf, size_t size)
                 timeout = least_timeout;
             }
         }
+    } else if (p_serial->rx_block_num >= 2) {
+        idx = __serial_read_block(p_serial, p_buffer, size);
     } else {
         lm_semb_take(&p_serial->ro_sync_semb, LM_SEM_WAIT_FOREVER);
         if (*p_serial->recv_size > size) {
@@ -195,88 +563,1419 @@ int lm_serial_read (int com, void *p_buf, size_t size)
         }
     }
 
+    __serial_perf_inc(p_serial, reads);
+    __serial_perf_add(p_serial, rx_bytes, idx);
+
     lm_mutex_unlock(&p_serial->ro_mutex);
 
     return idx;
 }
 
 /*
- * 串口发送
+ * 等待接收缓存区至少有need字节, 在ro_mutex保护下调用
+ *
+ * 任务通知方式下接收空闲等事件也会提前返回, 调用者需要重新检查数据量
  */
-int lm_serial_write (int com, const void *p_buf, size_t size)
+static int __serial_rx_wait (struct lm_serial_port *p_serial,
+                             size_t                 need,
+                             uint32_t               timeout)
 {
-    struct lm_serial_port *p_serial;
-    size_t           wlen      = 0;
+    uint32_t events;
+    int      ret = LM_OK;
 
-    if (lm_is_int_context()) {
-        return -LM_ENOTSUP;
+    if (!p_serial->rx_notify) {
+        return lm_semb_take(&p_serial->ro_sync_semb, timeout);
     }
 
-    if ((com >= COM_MUX ) || (p_buf == NULL) || ((int)size <= 0)) {
-        return -LM_EINVAL;
+    p_serial->rx_want = need;
+    lm_atomic_store_release(&p_serial->rx_waiter, lm_task_self());
+    if (lm_ringbuf_data_len(&p_serial->rbuf) < need) {
+        ret = lm_task_notify_wait(__SERIAL_RX_EVT_ALL, &events, timeout);
     }
+    lm_atomic_store_release(&p_serial->rx_waiter, NULL);
 
-    p_serial = __com2serial(com);
+    return ret;
+}
 
-    if (NULL == p_serial) {
-        return -LM_ENODEV;
+/*
+ * 计算剩余的读超时(ms), 总超时已到返回false
+ */
+static bool __serial_rx_remain (uint32_t total, uint32_t start_tick, uint32_t *p_remain)
+{
+    uint32_t use_time;
+
+    if (total == (uint32_t)-1) {
+        *p_remain = total;
+        return true;
     }
 
-    lm_mutex_lock(&p_serial->wr_mutex, LM_SEM_WAIT_FOREVER);
+    use_time = lm_tick_to_ms(lm_sys_get_tick() - start_tick);
+    if (use_time >= total) {
+        return false;
+    }
 
-    if (p_serial->serial_info.config.transmit_type) {
-        if (p_serial->p_ops->pfunc_send_dma) {
-            wlen = p_serial->p_ops->pfunc_send_dma(p_serial, p_buf, size);
+    *p_remain = total - use_time;
+
+    return true;
+}
+
+/*
+ * 在接收缓存区前len字节可读数据中, 从第offset字节开始查找ch
+ *
+ * 直接在环形缓存区中用memchr()查找(按字比较), 不逐字节拷贝出来,
+ * 返回ch相对可读数据起始的位置, 没有找到返回-1
+ */
+static int __serial_rx_scan (struct lm_serial_port *p_serial,
+                             size_t                 offset,
+                             size_t                 len,
+                             uint8_t                ch)
+{
+    struct lm_ringbuf_span span[2];
+    const uint8_t         *p;
+    size_t                 start, from, n;
+    int                    i;
+
+    lm_ringbuf_peek_contig(&p_serial->rbuf, span);
+
+    for (i = 0, start = 0; (i < 2) && (start < len); start += span[i].len, i++) {
+        n = (span[i].len < len - start) ? span[i].len : len - start;
+        if (offset >= start + n) {
+            continue;
         }
-    } else {
-        if (p_serial->p_ops->pfunc_send) {
-            wlen = p_serial->p_ops->pfunc_send(p_serial, p_buf, size);
+
+        from = (offset > start) ? offset - start : 0;
+        p    = memchr(&span[i].ptr[from], ch, n - from);
+        if (p != NULL) {
+            return (int)(start + (p - span[i].ptr));
         }
     }
 
-    lm_mutex_unlock(&p_serial->wr_mutex);
+    return -1;
+}
 
-    return wlen;
+/*
+ * 读取可读数据中第idx个字节(不移出)
+ */
+static uint8_t __serial_rx_peek (struct lm_serial_port *p_serial, size_t idx)
+{
+    struct lm_ringbuf_span span[2];
+
+    lm_ringbuf_peek_contig(&p_serial->rbuf, span);
+
+    return (idx < span[0].len) ? span[0].ptr[idx] : span[1].ptr[idx - span[0].len];
 }
 
 /*
- * 注册串口驱动
+ * 取出一帧, 缓存区还有数据时保证下次读能立即返回
  */
-int lm_serial_register (struct lm_serial_port *p_serial)
+static int __serial_rx_take (struct lm_serial_port *p_serial, void *p_buf, size_t len)
 {
-    int ret = LM_OK;
+    len = lm_ringbuf_get(&p_serial->rbuf, (uint8_t *)p_buf, (uint16_t)len);
+
+    if (!p_serial->rx_notify && lm_ringbuf_data_len(&p_serial->rbuf)) {
+        lm_semb_give(&p_serial->ro_sync_semb);
+    }
+
+    __serial_perf_inc(p_serial, reads);
+    __serial_perf_add(p_serial, rx_bytes, len);
+
+    return (int)len;
+}
+
+/*
+ * 帧过长或长度非法时丢弃len字节, 无法确定帧边界
+ */
+static int __serial_rx_discard (struct lm_serial_port *p_serial, size_t len)
+{
+    len = lm_ringbuf_consume(&p_serial->rbuf, len);
+
+    /* dropped也在接收中断中累加 */
+    lm_critical_enter();
+    p_serial->rx_stat.dropped += len;
+    lm_critical_exit();
+
+    return -LM_EFULL;
+}
 
+/*
+ * 获取按帧读取的串口, 成功时已持有ro_mutex
+ */
+static struct lm_serial_port *__serial_frame_port (int com, void *p_buf, size_t max, int *p_ret)
+{
+    struct lm_serial_port *p_serial;
+
+    *p_ret = -LM_EINVAL;
+    if (lm_is_int_context()) {
+        *p_ret = -LM_ENOTSUP;
+        return NULL;
+    }
+
+    if ((com >= COM_MUX) || (p_buf == NULL) || (max == 0)) {
+        return NULL;
+    }
+
+    p_serial = __com2serial(com);
     if (p_serial == NULL) {
-        return -LM_EINVAL;
+        *p_ret = -LM_ENODEV;
+        return NULL;
     }
 
-    if ((p_serial->recv_buf  == NULL) || \
-        ((p_serial->id) >= COM_MUX)||(p_serial->id < 0))  {
-        return -LM_EINVAL;
+    /* 只有环形缓存区接收方式支持按帧读取 */
+    if (p_serial->serial_info.config.transmit_type || (p_serial->rx_block_num >= 2)) {
+        *p_ret = -LM_ENOTSUP;
+        return NULL;
     }
 
-    /* 该设备是否已近创建 */
-    if (__com2serial(p_serial->id) == NULL) {
-        __com2serial(p_serial->id) = p_serial;
-    } else {
-        return -LM_EEXIST;
+    __serial_lock(p_serial, &p_serial->ro_mutex);
+
+    return p_serial;
+}
+
+/**
+ * @brief 读取一帧, 以分隔符结束
+ */
+int lm_serial_read_until (int com, void *p_buf, size_t max, uint8_t delim)
+{
+    struct lm_serial_port *p_serial;
+    size_t                 avail, scanned = 0, cap;
+    uint32_t               start_tick, remain, total;
+    bool                   expired = false;
+    int                    ret, pos;
+
+    p_serial = __serial_frame_port(com, p_buf, max, &ret);
+    if (p_serial == NULL) {
+        return ret;
     }
 
-    /* 初始化环形缓存区 */
-    lm_ringbuf_init(&p_serial->rbuf, p_serial->recv_buf, p_serial->buf_size);
+    __serial_rx_timeouts(p_serial, &total, NULL, NULL);
+    cap        = lm_ringbuf_get_size(&p_serial->rbuf);
+    cap        = (max < cap) ? max : cap;
+    start_tick = lm_sys_get_tick();
 
-    /* 创建同步锁和信号量 */
-    lm_mutex_create(&p_serial->wr_mutex);
-    lm_mutex_create(&p_serial->ro_mutex);
-    lm_semb_create(&p_serial->ro_sync_semb);
+    for (;;) {
+        /* 只查找新到达的数据 */
+        avail = lm_ringbuf_data_len(&p_serial->rbuf);
+        pos   = __serial_rx_scan(p_serial, scanned, (avail < cap) ? avail : cap, delim);
+        if (pos >= 0) {
+            ret = __serial_rx_take(p_serial, p_buf, pos + 1);
+            break;
+        }
 
-    /* 初始化默认配置 */
-    memcpy(&p_serial->serial_info,
-           &__g_serial_info_default,  sizeof(p_serial->serial_info));
+        if (avail >= cap) {
+            ret = __serial_rx_discard(p_serial, cap);
+            break;
+        }
+        scanned = avail;
 
-    lm_list_add_tail(&p_serial->list , &__g_spi_list);
+        if (expired || !__serial_rx_remain(total, start_tick, &remain)) {
+            ret = 0;
+            break;
+        }
+
+        if (__serial_rx_wait(p_serial, avail + 1, remain) != LM_OK) {
+            /* 超时前最后再检查一次 */
+            expired = true;
+        }
+    }
+
+    lm_mutex_unlock(&p_serial->ro_mutex);
 
     return ret;
 }
 
+/**
+ * @brief 读取一帧, 帧长由帧头中的长度字段决定
+ */
+int lm_serial_read_frame (int                              com,
+                          void                            *p_buf,
+                          size_t                           max,
+                          const struct lm_serial_frame_fmt *p_fmt)
+{
+    struct lm_serial_port *p_serial;
+    size_t                 avail, hdr, need, cap;
+    uint32_t               start_tick, remain, total, value;
+    bool                   expired = false;
+    int                    ret, i;
+
+    if ((p_fmt == NULL) || (p_fmt->len_size == 0) || (p_fmt->len_size > 2)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __serial_frame_port(com, p_buf, max, &ret);
+    if (p_serial == NULL) {
+        return ret;
+    }
+
+    cap        = lm_ringbuf_get_size(&p_serial->rbuf);
+    cap        = (max < cap) ? max : cap;
+    hdr        = p_fmt->len_offset + p_fmt->len_size;
+    need       = hdr;
+    start_tick = lm_sys_get_tick();
+    __serial_rx_timeouts(p_serial, &total, NULL, NULL);
+
+    for (;;) {
+        avail = lm_ringbuf_data_len(&p_serial->rbuf);
+
+        /* 收齐帧头后由长度字段得到帧长 */
+        if ((need == hdr) && (avail >= hdr)) {
+            value = 0;
+            for (i = 0; i < p_fmt->len_size; i++) {
+                if (p_fmt->big_endian) {
+                    value = (value << 8) | __serial_rx_peek(p_serial, p_fmt->len_offset + i);
+                } else {
+                    value |= (uint32_t)__serial_rx_peek(p_serial, p_fmt->len_offset + i) << (8 * i);
+                }
+            }
+
+            if (((int32_t)value + p_fmt->len_adjust < (int32_t)hdr) ||
+                ((int32_t)value + p_fmt->len_adjust > (int32_t)cap)) {
+                ret = __serial_rx_discard(p_serial, avail);
+                break;
+            }
+            need = value + p_fmt->len_adjust;
+        }
+
+        if (avail >= need) {
+            ret = __serial_rx_take(p_serial, p_buf, need);
+            break;
+        }
+
+        if (expired || !__serial_rx_remain(total, start_tick, &remain)) {
+            ret = 0;
+            break;
+        }
+
+        if (__serial_rx_wait(p_serial, need, remain) != LM_OK) {
+            expired = true;
+        }
+    }
+
+    lm_mutex_unlock(&p_serial->ro_mutex);
+
+    return ret;
+}
+
+/*
+ * 发送是否已完成(没有排队, DMA正在发送和等待TC的数据)
+ */
+static inline bool __serial_tx_empty (struct lm_serial_port *p_serial)
+{
+    return (lm_ringbuf_data_len(&p_serial->tbuf) == 0) &&
+           (lm_atomic_load_acquire(&p_serial->tx_inflight) == 0) &&
+           (lm_atomic_load_acquire(&p_serial->tx_hw_busy) == 0);
+}
+
+/*
+ * 等待发送队列排空, 在wr_mutex保护下调用
+ */
+static int __serial_tx_drain (struct lm_serial_port *p_serial, uint32_t timeout)
+{
+    uint32_t start_tick = lm_sys_get_tick();
+    uint32_t use_time;
+
+    while (!__serial_tx_empty(p_serial)) {
+
+        if (timeout == LM_SEM_WAIT_FOREVER) {
+            lm_semb_take(&p_serial->tx_done_semb, LM_SEM_WAIT_FOREVER);
+            continue;
+        }
+
+        use_time = lm_tick_to_ms(lm_sys_get_tick() - start_tick);
+        if ((use_time >= timeout) ||
+            (lm_semb_take(&p_serial->tx_done_semb, timeout - use_time) != LM_OK)) {
+            return __serial_tx_empty(p_serial) ? LM_OK : -LM_ETIMEOUT;
+        }
+    }
+
+    return LM_OK;
+}
+
+/*
+ * 串口发送
+ */
+int lm_serial_write (int com, const void *p_buf, size_t size)
+{
+    struct lm_serial_port *p_serial;
+    size_t           wlen      = 0;
+    uint32_t         start     = lm_us_stamp();
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    if ((com >= COM_MUX ) || (p_buf == NULL) || ((int)size <= 0)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    __serial_lock(p_serial, &p_serial->wr_mutex);
+
+    /* 先等发送队列中的数据发完, 保证输出顺序 */
+    if (p_serial->send_buf) {
+        __serial_tx_drain(p_serial, LM_SEM_WAIT_FOREVER);
+    }
+
+    if (p_serial->serial_info.config.transmit_type) {
+        if (p_serial->p_ops->pfunc_send_dma) {
+            wlen = p_serial->p_ops->pfunc_send_dma(p_serial, p_buf, size);
+        }
+    } else {
+        if (p_serial->p_ops->pfunc_send) {
+            wlen = p_serial->p_ops->pfunc_send(p_serial, p_buf, size);
+        }
+    }
+
+    __serial_perf_write_done(p_serial, wlen, start);
+
+    lm_mutex_unlock(&p_serial->wr_mutex);
+
+    return wlen;
+}
+
+/*
+ * 借用一块已接收的数据
+ */
+int lm_serial_rx_borrow (int com, const uint8_t **pp_data, uint32_t timeout)
+{
+    struct lm_serial_port *p_serial;
+    int                    ret;
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    if ((com >= COM_MUX) || (pp_data == NULL)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    if (p_serial->rx_block_num < 2) {
+        return -LM_ENOTSUP;
+    }
+
+    lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
+    ret = __serial_block_borrow(p_serial, pp_data, timeout);
+    lm_mutex_unlock(&p_serial->ro_mutex);
+
+    return ret;
+}
+
+/*
+ * 归还最早借用的数据块
+ */
+int lm_serial_rx_return (int com)
+{
+    struct lm_serial_port *p_serial;
+    int                    ret;
+
+    if (com >= COM_MUX) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    if (p_serial->rx_block_num < 2) {
+        return -LM_ENOTSUP;
+    }
+
+    lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
+    ret = __serial_block_return(p_serial);
+    lm_mutex_unlock(&p_serial->ro_mutex);
+
+    return ret;
+}
+
+/*
+ * 串口可读的字节数(DMA多缓存接收时为下一块的长度)
+ */
+static size_t __serial_rx_avail (struct lm_serial_port *p_serial)
+{
+    uint32_t borrow;
+
+    if (p_serial->rx_block_num >= 2) {
+        borrow = p_serial->rx_block_borrow;
+        if (borrow == lm_atomic_load_acquire(&p_serial->rx_block_head)) {
+            return 0;
+        }
+        return p_serial->rx_block_len[borrow % p_serial->rx_block_num];
+    }
+
+    return lm_ringbuf_data_len(&p_serial->rbuf);
+}
+
+/*
+ * 获取串口可读的字节数
+ */
+int lm_serial_rx_available (int com)
+{
+    struct lm_serial_port *p_serial;
+
+    if (com >= COM_MUX) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    return (int)__serial_rx_avail(p_serial);
+}
+
+/*
+ * 检查多个串口中有数据可读的串口
+ */
+static uint32_t __serial_rx_ready (uint32_t mask)
+{
+    uint32_t ready = 0;
+    int      com;
+
+    for (com = COM0; com < COM_MUX; com++) {
+        if ((mask & BIT(com)) && __serial_rx_avail(__com2serial(com))) {
+            ready |= BIT(com);
+        }
+    }
+
+    return ready;
+}
+
+/*
+ * 登记或注销多串口等待的任务, 串口已被其他任务等待时返回false
+ */
+static bool __serial_select_set (uint32_t mask, lm_task_handle_t task)
+{
+    bool ok = true;
+    int  com;
+
+    lm_critical_enter();
+    for (com = COM0; com < COM_MUX; com++) {
+        if (task && (mask & BIT(com)) && (__com2serial(com)->rx_select != NULL)) {
+            ok = false;
+        }
+    }
+    if (ok) {
+        for (com = COM0; com < COM_MUX; com++) {
+            if (mask & BIT(com)) {
+                lm_atomic_store_release(&__com2serial(com)->rx_select, task);
+            }
+        }
+    }
+    lm_critical_exit();
+
+    return ok;
+}
+
+/*
+ * 等待多个串口中任意一个有数据可读
+ */
+int lm_serial_wait_any (uint32_t mask, uint32_t timeout)
+{
+    uint32_t  ready;
+    lm_tick_t start;
+    uint32_t  remain, use_time;
+    int       com;
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    mask &= BIT(COM_MUX) - 1;
+    for (com = COM0; com < COM_MUX; com++) {
+        if ((mask & BIT(com)) && (__com2serial(com) == NULL)) {
+            mask &= ~BIT(com);
+        }
+    }
+
+    if (mask == 0) {
+        return -LM_EINVAL;
+    }
+
+    /* 登记后接收中断才会通知本任务 */
+    if (!__serial_select_set(mask, lm_task_self())) {
+        return -LM_EBUSY;
+    }
+
+    /* 先清通知位再检查, 检查之后到达的数据一定会发送通知 */
+    lm_task_notify_clear(__SERIAL_RX_EVT_SELECT);
+
+    start  = lm_sys_get_tick();
+    remain = timeout;
+    for (;;) {
+        ready = __serial_rx_ready(mask);
+        if (ready) {
+            break;
+        }
+
+        if (timeout != LM_SEM_WAIT_FOREVER) {
+            use_time = lm_tick_to_ms(lm_sys_get_tick() - start);
+            if (use_time >= timeout) {
+                break;
+            }
+            remain = timeout - use_time;
+        }
+
+        /* 通知可能来自已经被读空的串口, 醒来后重新检查 */
+        if (lm_task_notify_wait(__SERIAL_RX_EVT_SELECT, NULL, remain) != LM_OK) {
+            ready = __serial_rx_ready(mask);
+            break;
+        }
+    }
+
+    __serial_select_set(mask, NULL);
+
+    return (int)ready;
+}
+
+/*
+ * 串口分散发送
+ */
+int lm_serial_writev (int com, const struct lm_serial_iovec *iov, int cnt)
+{
+    struct lm_serial_port *p_serial;
+    int                    wlen = 0, ret, i;
+    uint32_t               start = lm_us_stamp();
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    if ((com >= COM_MUX ) || (iov == NULL) || (cnt <= 0)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    __serial_lock(p_serial, &p_serial->wr_mutex);
+
+    /* 先等发送队列中的数据发完, 保证输出顺序 */
+    if (p_serial->send_buf) {
+        __serial_tx_drain(p_serial, LM_SEM_WAIT_FOREVER);
+    }
+
+    if (p_serial->p_ops->pfunc_sendv) {
+        wlen = p_serial->p_ops->pfunc_sendv(p_serial, iov, cnt);
+    } else {
+        /* 持有写锁逐个片段发送, 片段之间不会插入其他数据 */
+        for (i = 0; i < cnt; i++) {
+            if ((iov[i].base == NULL) || (iov[i].len == 0)) {
+                continue;
+            }
+
+            ret = 0;
+            if (p_serial->serial_info.config.transmit_type) {
+                if (p_serial->p_ops->pfunc_send_dma) {
+                    ret = p_serial->p_ops->pfunc_send_dma(p_serial,
+                                                          iov[i].base, iov[i].len);
+                }
+            } else {
+                if (p_serial->p_ops->pfunc_send) {
+                    ret = p_serial->p_ops->pfunc_send(p_serial,
+                                                      iov[i].base, iov[i].len);
+                }
+            }
+
+            if (ret < 0) {
+                wlen = (wlen == 0) ? ret : wlen;
+                break;
+            }
+            wlen += ret;
+        }
+    }
+
+    __serial_perf_write_done(p_serial, (wlen > 0) ? wlen : 0, start);
+
+    lm_mutex_unlock(&p_serial->wr_mutex);
+
+    return wlen;
+}
+
+/*
+ * 发送队列满时丢弃最早的未发送数据, 返回腾出的空间
+ */
+static size_t __serial_tx_overwrite (struct lm_serial_port *p_serial, size_t need)
+{
+    size_t len;
+
+    /* 与发送中断互斥; DMA正在发送的数据不能覆盖 */
+    lm_critical_enter();
+
+    len = 0;
+    if (p_serial->tx_inflight == 0) {
+        len = lm_ringbuf_data_len(&p_serial->tbuf);
+        if (len > need) {
+            len = need;
+        }
+        lm_ringbuf_consume(&p_serial->tbuf, len);
+    }
+
+    lm_critical_exit();
+
+    p_serial->tx_dropped += len;
+
+    return len;
+}
+
+/*
+ * 写入发送队列, 返回写入的长度
+ */
+static size_t __serial_tx_put (struct lm_serial_port *p_serial,
+                               const uint8_t         *p_buf,
+                               size_t                 size)
+{
+    size_t len = 0, wlen, chunk;
+
+    while (len < size) {
+        chunk = size - len;
+        if (chunk > 0xFFFF) {
+            chunk = 0xFFFF;
+        }
+
+        wlen = lm_ringbuf_put(&p_serial->tbuf, &p_buf[len], chunk);
+        len += wlen;
+        if (wlen < chunk) {
+            break;
+        }
+    }
+
+    return len;
+}
+
+/*
+ * 串口异步发送
+ */
+int lm_serial_write_async (int com, const void *p_buf, size_t size)
+{
+    struct lm_serial_port *p_serial;
+    const uint8_t         *p_data = (const uint8_t *)p_buf;
+    size_t                 len = 0, space;
+    uint32_t               start_tick, use_time;
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    if ((com >= COM_MUX ) || (p_buf == NULL) || ((int)size <= 0)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    if ((p_serial->send_buf == NULL) || (p_serial->p_ops->pfunc_tx_start == NULL)) {
+        return -LM_ENOTSUP;
+    }
+
+    __serial_lock(p_serial, &p_serial->wr_mutex);
+
+    space = lm_ringbuf_get_size(&p_serial->tbuf) -
+            lm_ringbuf_data_len(&p_serial->tbuf);
+
+    if (space < size) {
+        if (p_serial->tx_policy == LM_SERIAL_TX_DROP) {
+            /* 整段丢弃, 不输出半条数据 */
+            p_serial->tx_dropped += size;
+            lm_mutex_unlock(&p_serial->wr_mutex);
+            return 0;
+        } else if (p_serial->tx_policy == LM_SERIAL_TX_OVERWRITE) {
+            __serial_tx_overwrite(p_serial, size - space);
+        }
+    }
+
+    start_tick = lm_sys_get_tick();
+
+    while (1) {
+        len += __serial_tx_put(p_serial, &p_data[len], size - len);
+        p_serial->p_ops->pfunc_tx_start(p_serial);
+
+        if ((len == size) || (p_serial->tx_policy != LM_SERIAL_TX_BLOCK)) {
+            break;
+        }
+
+        /* 等待发送中断腾出空间 */
+        if (p_serial->tx_timeout == LM_SEM_WAIT_FOREVER) {
+            lm_semb_take(&p_serial->tx_space_semb, LM_SEM_WAIT_FOREVER);
+            continue;
+        }
+
+        use_time = lm_tick_to_ms(lm_sys_get_tick() - start_tick);
+        if ((use_time >= p_serial->tx_timeout) ||
+            (lm_semb_take(&p_serial->tx_space_semb,
+                          p_serial->tx_timeout - use_time) != LM_OK)) {
+            len += __serial_tx_put(p_serial, &p_data[len], size - len);
+            break;
+        }
+    }
+
+    if (len < size && p_serial->tx_policy != LM_SERIAL_TX_BLOCK) {
+        p_serial->tx_dropped += size - len;
+    }
+
+    __serial_perf_add(p_serial, tx_bytes, len);
+
+    lm_mutex_unlock(&p_serial->wr_mutex);
+
+    return len;
+}
+
+/*
+ * 设置发送队列满时的处理方式
+ */
+int lm_serial_set_tx_policy (int com, int policy, uint32_t timeout)
+{
+    struct lm_serial_port *p_serial;
+
+    if ((com >= COM_MUX) ||
+        (policy < LM_SERIAL_TX_BLOCK) || (policy > LM_SERIAL_TX_OVERWRITE)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    lm_mutex_lock(&p_serial->wr_mutex, LM_SEM_WAIT_FOREVER);
+    p_serial->tx_policy  = policy;
+    p_serial->tx_timeout = timeout;
+    lm_mutex_unlock(&p_serial->wr_mutex);
+
+    return LM_OK;
+}
+
+/*
+ * 等待发送队列排空
+ */
+int lm_serial_flush (int com, uint32_t timeout)
+{
+    struct lm_serial_port *p_serial;
+    int                    ret = LM_OK;
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    if (com >= COM_MUX) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    if (p_serial->send_buf == NULL) {
+        return LM_OK;
+    }
+
+    lm_mutex_lock(&p_serial->wr_mutex, LM_SEM_WAIT_FOREVER);
+    ret = __serial_tx_drain(p_serial, timeout);
+    lm_mutex_unlock(&p_serial->wr_mutex);
+
+    return ret;
+}
+
+/*
+ * 唤醒读任务
+ */
+static inline void __serial_rx_wakeup (struct lm_serial_port *p_serial)
+{
+    /* 信号量已经是有效状态时不算一次唤醒 */
+    if (lm_semb_give(&p_serial->ro_sync_semb) == LM_OK) {
+        p_serial->rx_stat.wakeups++;
+    }
+}
+
+/*
+ * 串口有新数据, 通知lm_serial_wait_any()(中断中调用)
+ */
+static inline void __serial_rx_select (struct lm_serial_port *p_serial)
+{
+    lm_task_handle_t task = lm_atomic_load_acquire(&p_serial->rx_select);
+
+    if (task != NULL) {
+        lm_task_notify(task, __SERIAL_RX_EVT_SELECT);
+    }
+}
+
+/*
+ * 接收事件处理(中断中调用), events为已经检测到的分隔符或空闲事件
+ */
+static void __serial_rx_event (struct lm_serial_port *p_serial, uint32_t events)
+{
+    lm_task_handle_t task;
+    size_t           len = lm_ringbuf_data_len(&p_serial->rbuf);
+
+    /* 记录最近一次事件是否为接收空闲, 新数据到达时清除 */
+    p_serial->rx_idle_flag = (events & __SERIAL_RX_EVT_IDLE) ? 1 : 0;
+
+    if (len && !(events & __SERIAL_RX_EVT_IDLE)) {
+        __serial_rx_select(p_serial);
+    }
+
+    /* 信号量方式 */
+    if (!p_serial->rx_notify) {
+        if (events & __SERIAL_RX_EVT_IDLE) {
+            if (len || p_serial->rx_hw_idle) {
+                __serial_rx_wakeup(p_serial);
+            }
+        } else if ((p_serial->rx_watermark == 0) ||
+                   (len >= p_serial->rx_watermark)) {
+            __serial_rx_wakeup(p_serial);
+        }
+        return;
+    }
+
+    /* 任务通知方式: 只有读任务在等待且满足唤醒条件时才通知 */
+    task = lm_atomic_load_acquire(&p_serial->rx_waiter);
+    if (task == NULL) {
+        return;
+    }
+
+    /* 读任务已经取走部分数据时, 缓存区为空也要通知它结束 */
+    if (!p_serial->rx_trigger.idle && !p_serial->rx_hw_idle) {
+        events &= ~__SERIAL_RX_EVT_IDLE;
+    }
+    if (len >= p_serial->rx_want) {
+        events |= __SERIAL_RX_EVT_LEVEL;
+    }
+    if (events == 0) {
+        return;
+    }
+
+    /* 读任务重新登记前不再重复通知 */
+    lm_atomic_store_relaxed(&p_serial->rx_waiter, NULL);
+    p_serial->rx_stat.wakeups++;
+
+    /* 虚拟串口(pty, mux)的接收在任务中调用, 由lm_task_notify区分上下文 */
+    lm_task_notify(task, events);
+}
+
+/*
+ * 在ring中从offset开始的len字节里查找分隔符
+ */
+static bool __serial_rx_find_delim (struct lm_serial_port *p_serial,
+                                    uint32_t               offset,
+                                    size_t                 len)
+{
+    uint32_t size = p_serial->buf_size;
+    size_t   first;
+
+    if (p_serial->rx_trigger.delimiter == LM_SERIAL_RX_DELIM_NONE) {
+        return false;
+    }
+
+    first = (len > size - offset) ? size - offset : len;
+    if (memchr(&p_serial->recv_buf[offset],
+               (uint8_t)p_serial->rx_trigger.delimiter, first)) {
+        return true;
+    }
+
+    return (len > first) &&
+           memchr(p_serial->recv_buf,
+                  (uint8_t)p_serial->rx_trigger.delimiter, len - first);
+}
+
+/*
+ * 批量接收
+ */
+size_t lm_uart_port_rx_burst (struct lm_serial_port *p_serial,
+                              const uint8_t         *p_buf,
+                              size_t                 size)
+{
+    size_t   len = 0, remain = size;
+    uint32_t events = 0;
+
+    if ((p_serial == NULL) || (p_buf == NULL) || (size == 0)) {
+        return 0;
+    }
+
+    /* lm_ringbuf_put的长度参数是16位的, 超长的DMA数据块分段写入 */
+    while (remain) {
+        size_t chunk = (remain > 0xFFFF) ? 0xFFFF : remain;
+        size_t wlen  = lm_ringbuf_put(&p_serial->rbuf, &p_buf[len], chunk);
+
+        len    += wlen;
+        remain -= wlen;
+        if (wlen < chunk) {
+            break;
+        }
+    }
+
+    p_serial->rx_stat.bursts++;
+    p_serial->rx_stat.bytes   += len;
+    p_serial->rx_stat.dropped += size - len;
+
+    if (p_serial->rx_notify &&
+        (p_serial->rx_trigger.delimiter != LM_SERIAL_RX_DELIM_NONE) &&
+        memchr(p_buf, (uint8_t)p_serial->rx_trigger.delimiter, len)) {
+        events = __SERIAL_RX_EVT_DELIM;
+    }
+
+    __serial_rx_event(p_serial, events);
+
+    return len;
+}
+
+/*
+ * 循环DMA接收事件
+ */
+size_t lm_uart_port_rx_dma_event (struct lm_serial_port *p_serial)
+{
+    size_t   len;
+    uint32_t pos, events = 0;
+
+    if ((p_serial == NULL) || (p_serial->p_ops->pfunc_get_rx_dma_pos == NULL)) {
+        return 0;
+    }
+
+    pos = p_serial->p_ops->pfunc_get_rx_dma_pos(p_serial);
+    len = lm_ringbuf_dma_update(&p_serial->rbuf, pos);
+    if (len == 0) {
+        return 0;
+    }
+
+    p_serial->rx_stat.bursts++;
+    p_serial->rx_stat.bytes += len;
+
+    /* 只在新发布的数据中查找分隔符 */
+    if (p_serial->rx_notify &&
+        __serial_rx_find_delim(p_serial,
+                               (pos + p_serial->buf_size - len) %
+                               p_serial->buf_size,
+                               len)) {
+        events = __SERIAL_RX_EVT_DELIM;
+    }
+
+    __serial_rx_event(p_serial, events);
+
+    return len;
+}
+
+/*
+ * 接收空闲
+ */
+void lm_uart_port_rx_flush (struct lm_serial_port *p_serial)
+{
+    if (p_serial == NULL) {
+        return;
+    }
+
+    __serial_rx_event(p_serial, __SERIAL_RX_EVT_IDLE);
+}
+
+/*
+ * 发送队列数据被取走后通知等待的任务
+ *
+ * 有TC中断的驱动由lm_uart_port_tx_complete()通知发送完成, 这里只在
+ * 驱动没有TC时把队列排空当作发送完成
+ */
+static void __serial_tx_release (struct lm_serial_port *p_serial)
+{
+    lm_semb_give(&p_serial->tx_space_semb);
+
+    if (!p_serial->tx_tc && __serial_tx_empty(p_serial)) {
+        lm_semb_give(&p_serial->tx_done_semb);
+    }
+}
+
+/*
+ * DMA多缓存接收: 获取当前应该填充的缓存块
+ */
+uint8_t *lm_uart_port_rx_block_get (struct lm_serial_port *p_serial)
+{
+    uint32_t idx;
+
+    if ((p_serial == NULL) || (p_serial->rx_block_num < 2)) {
+        return NULL;
+    }
+
+    idx = p_serial->rx_block_head % p_serial->rx_block_num;
+
+    return &p_serial->recv_buf[idx * p_serial->rx_block_size];
+}
+
+/*
+ * DMA多缓存接收: 当前块接收完成
+ */
+uint8_t *lm_uart_port_rx_block_done (struct lm_serial_port *p_serial,
+                                     uint32_t               len)
+{
+    uint32_t head, tail;
+
+    if ((p_serial == NULL) || (p_serial->rx_block_num < 2)) {
+        return NULL;
+    }
+
+    head = p_serial->rx_block_head;
+    tail = lm_atomic_load_acquire(&p_serial->rx_block_tail);
+
+    if (len == 0) {
+        return lm_uart_port_rx_block_get(p_serial);
+    }
+
+    /* 下一块还没有归还, 重复使用当前块, 丢弃本次数据 */
+    if (head + 1 - tail >= p_serial->rx_block_num) {
+        p_serial->rx_block_dropped++;
+        p_serial->rx_stat.dropped += len;
+        return lm_uart_port_rx_block_get(p_serial);
+    }
+
+    p_serial->rx_block_len[head % p_serial->rx_block_num] =
+        (len > p_serial->rx_block_size) ? p_serial->rx_block_size : len;
+    lm_atomic_store_release(&p_serial->rx_block_head, head + 1);
+
+    p_serial->rx_stat.bursts++;
+    p_serial->rx_stat.bytes += len;
+    __serial_rx_wakeup(p_serial);
+    __serial_rx_select(p_serial);
+
+    return lm_uart_port_rx_block_get(p_serial);
+}
+
+/*
+ * 从发送队列取数据
+ */
+size_t lm_uart_port_tx_get (struct lm_serial_port *p_serial,
+                            uint8_t               *p_buf,
+                            size_t                 size)
+{
+    size_t len;
+
+    if ((p_serial == NULL) || (p_serial->send_buf == NULL) || (p_buf == NULL)) {
+        return 0;
+    }
+
+    len = lm_ringbuf_get(&p_serial->tbuf, p_buf, (size > 0xFFFF) ? 0xFFFF : size);
+
+    /* 数据交给硬件后到TC之前都算正在发送 */
+    if (len && p_serial->tx_tc) {
+        lm_atomic_store_release(&p_serial->tx_hw_busy, 1);
+    }
+
+    __serial_tx_release(p_serial);
+
+    return len;
+}
+
+/*
+ * 获取发送队列中第一段连续数据
+ */
+size_t lm_uart_port_tx_peek (struct lm_serial_port  *p_serial,
+                             const uint8_t         **pp_data)
+{
+    struct lm_ringbuf_span span[2];
+
+    if ((p_serial == NULL) || (p_serial->send_buf == NULL) || (pp_data == NULL)) {
+        return 0;
+    }
+
+    if (lm_ringbuf_peek_contig(&p_serial->tbuf, span) == 0) {
+        return 0;
+    }
+
+    *pp_data = span[0].ptr;
+    if (p_serial->tx_tc) {
+        lm_atomic_store_release(&p_serial->tx_hw_busy, 1);
+    }
+    lm_atomic_store_release(&p_serial->tx_inflight, (uint32_t)span[0].len);
+
+    return span[0].len;
+}
+
+/*
+ * DMA发送完成
+ */
+void lm_uart_port_tx_done (struct lm_serial_port *p_serial, size_t len)
+{
+    if ((p_serial == NULL) || (p_serial->send_buf == NULL)) {
+        return;
+    }
+
+    lm_ringbuf_consume(&p_serial->tbuf, len);
+    lm_atomic_store_release(&p_serial->tx_inflight, 0);
+
+    __serial_tx_release(p_serial);
+}
+
+/*
+ * 发送完成(TC)
+ */
+void lm_uart_port_tx_complete (struct lm_serial_port *p_serial)
+{
+    if ((p_serial == NULL) || (p_serial->send_buf == NULL)) {
+        return;
+    }
+
+    lm_atomic_store_release(&p_serial->tx_hw_busy, 0);
+
+    /* TC之后队列里又有新数据时, 等下一次TC */
+    if (__serial_tx_empty(p_serial)) {
+        lm_semb_give(&p_serial->tx_done_semb);
+    }
+}
+
+/*
+ * 设置接收唤醒条件
+ */
+int lm_serial_set_rx_trigger (int                                com,
+                              const struct lm_serial_rx_trigger *p_trigger)
+{
+    struct lm_serial_port *p_serial;
+
+    if (lm_is_int_context()) {
+        return -LM_ENOTSUP;
+    }
+
+    if (com >= COM_MUX) {
+        return -LM_EINVAL;
+    }
+
+    if ((p_trigger != NULL) &&
+        (p_trigger->delimiter < LM_SERIAL_RX_DELIM_NONE ||
+         p_trigger->delimiter > 0xFF)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    /* 持有读锁, 修改时不会有任务在等待 */
+    lm_mutex_lock(&p_serial->ro_mutex, LM_SEM_WAIT_FOREVER);
+
+    p_serial->rx_notify = 0;
+    if (p_trigger != NULL) {
+        memcpy(&p_serial->rx_trigger, p_trigger, sizeof(*p_trigger));
+        p_serial->rx_notify = 1;
+    }
+
+    lm_mutex_unlock(&p_serial->ro_mutex);
+
+    return LM_OK;
+}
+
+/*
+ * 获取批量接收统计
+ */
+int lm_serial_get_rx_stat (int com, struct lm_serial_rx_stat *p_stat)
+{
+    struct lm_serial_port *p_serial;
+
+    if ((com >= COM_MUX) || (p_stat == NULL)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    /* 统计值只由中断累加, 读出的是一个近似快照 */
+    memcpy(p_stat, &p_serial->rx_stat, sizeof(*p_stat));
+
+    return LM_OK;
+}
+
+/*
+ * 获取串口性能统计
+ */
+int lm_serial_get_perf (int com, struct lm_serial_perf *p_perf)
+{
+#if LM_SERIAL_PERF_ENABLED
+    struct lm_serial_port *p_serial;
+
+    if ((com >= COM_MUX) || (p_perf == NULL)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    memcpy(p_perf, &p_serial->perf, sizeof(*p_perf));
+
+    return LM_OK;
+#else
+    (void)com;
+    (void)p_perf;
+
+    return -LM_ENOTSUP;
+#endif
+}
+
+/*
+ * 清除串口性能统计
+ */
+int lm_serial_clear_perf (int com)
+{
+#if LM_SERIAL_PERF_ENABLED
+    struct lm_serial_port *p_serial;
+
+    if (com >= COM_MUX) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    memset(&p_serial->perf, 0, sizeof(p_serial->perf));
+    memset(&p_serial->rx_stat, 0, sizeof(p_serial->rx_stat));
+
+    return LM_OK;
+#else
+    (void)com;
+
+    return -LM_ENOTSUP;
+#endif
+}
+
+/*
+ * 获取串口接收环形缓存区统计
+ */
+int lm_serial_get_ringbuf_stat (int com, struct lm_ringbuf_stat *p_stat)
+{
+    struct lm_serial_port *p_serial;
+
+    if ((com >= COM_MUX) || (p_stat == NULL)) {
+        return -LM_EINVAL;
+    }
+
+    p_serial = __com2serial(com);
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    return lm_ringbuf_get_stat(&p_serial->rbuf, p_stat);
+}
+
+/*
+ * 注册串口驱动
+ */
+int lm_serial_register (struct lm_serial_port *p_serial)
+{
+    int ret = LM_OK;
+
+    if (p_serial == NULL) {
+        return -LM_EINVAL;
+    }
+
+    if ((p_serial->recv_buf  == NULL) || \
+        ((p_serial->id) >= COM_MUX)||(p_serial->id < 0))  {
+        return -LM_EINVAL;
+    }
+
+    /* 该设备是否已近创建 */
+    if (__com2serial(p_serial->id) == NULL) {
+        __com2serial(p_serial->id) = p_serial;
+    } else {
+        return -LM_EEXIST;
+    }
+
+    /* 初始化环形缓存区 */
+    lm_ringbuf_init(&p_serial->rbuf, p_serial->recv_buf, p_serial->buf_size);
+
+    /* 创建同步锁和信号量 */
+    lm_mutex_create(&p_serial->wr_mutex);
+    lm_mutex_create(&p_serial->ro_mutex);
+    lm_semb_create(&p_serial->ro_sync_semb);
+
+    /* 发送队列(可选) */
+    if (p_serial->send_buf) {
+        lm_ringbuf_init(&p_serial->tbuf, p_serial->send_buf, p_serial->send_buf_size);
+        lm_semb_create(&p_serial->tx_space_semb);
+        lm_semb_create(&p_serial->tx_done_semb);
+    }
+    p_serial->tx_policy   = LM_SERIAL_TX_BLOCK;
+    p_serial->tx_timeout  = LM_SEM_WAIT_FOREVER;
+    p_serial->tx_inflight = 0;
+    p_serial->tx_hw_busy  = 0;
+    p_serial->tx_dropped  = 0;
+
+    /* DMA多缓存接收(可选) */
+    if (p_serial->rx_block_num > LM_SERIAL_RX_BLOCK_MAX) {
+        p_serial->rx_block_num = LM_SERIAL_RX_BLOCK_MAX;
+    }
+    if (p_serial->rx_block_num >= 2) {
+        p_serial->rx_block_size = p_serial->buf_size / p_serial->rx_block_num;
+    }
+    p_serial->rx_block_head    = 0;
+    p_serial->rx_block_borrow  = 0;
+    p_serial->rx_block_tail    = 0;
+    p_serial->rx_block_dropped = 0;
+
+    /* 初始化默认配置 */
+    memcpy(&p_serial->serial_info,
+           &__g_serial_info_default,  sizeof(p_serial->serial_info));
+    p_serial->info_seq     = 0;
+    p_serial->rx_idle_ms   = p_serial->serial_info.idle_timeout;
+    p_serial->rx_hw_idle   = 0;
+    p_serial->rx_idle_flag = 0;
+    memset(&p_serial->rx_stat, 0, sizeof(p_serial->rx_stat));
+#if LM_SERIAL_PERF_ENABLED
+    memset(&p_serial->perf, 0, sizeof(p_serial->perf));
+#endif
+    p_serial->rx_notify = 0;
+    p_serial->rx_waiter = NULL;
+    p_serial->rx_select = NULL;
+
+    lm_list_add_tail(&p_serial->list , &__g_spi_list);
+
+    return ret;
+}
+
+/*
+ * 注销串口驱动
+ */
+int lm_serial_unregister (int com)
+{
+    struct lm_serial_port *p_serial;
+
+    if ((com >= COM_MUX) || (com < 0)) {
+        return -LM_EINVAL;
+    }
+
+    lm_critical_enter();
+    p_serial = __com2serial(com);
+    if (p_serial != NULL) {
+        __com2serial(com) = NULL;
+        lm_list_del(&p_serial->list);
+    }
+    lm_critical_exit();
+
+    if (NULL == p_serial) {
+        return -LM_ENODEV;
+    }
+
+    lm_mutex_destroy(&p_serial->wr_mutex);
+    lm_mutex_destroy(&p_serial->ro_mutex);
+    lm_semb_destroy(&p_serial->ro_sync_semb);
+    if (p_serial->send_buf) {
+        lm_semb_destroy(&p_serial->tx_space_semb);
+        lm_semb_destroy(&p_serial->tx_done_semb);
+    }
+
+    return LM_OK;
+}
+
 /* end of file */
@@ -0,0 +1,293 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_serial_mux.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 串口逻辑通道复用模块
+*******************************************************************************/
+
+#include "lm_serial_mux.h"
+
+#define __chan_from_port(p_serial) \
+        ((struct lm_serial_mux_chan *)(p_serial))
+
+/**
+ * @brief CRC-8(多项式0x07)
+ */
+static uint8_t __mux_crc8 (const uint8_t *p_data, size_t len)
+{
+    uint8_t crc = 0;
+    int     i;
+
+    while (len--) {
+        crc ^= *p_data++;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief COBS编码, 返回编码后的长度
+ */
+static size_t __mux_cobs_encode (const uint8_t *p_src, size_t len, uint8_t *p_dst)
+{
+    size_t  code_pos = 0, out = 1, i;
+    uint8_t code     = 1;
+
+    for (i = 0; i < len; i++) {
+        if (p_src[i] == 0) {
+            p_dst[code_pos] = code;
+            code_pos        = out++;
+            code            = 1;
+        } else {
+            p_dst[out++] = p_src[i];
+            if (++code == 0xFF) {
+                p_dst[code_pos] = code;
+                code_pos        = out++;
+                code            = 1;
+            }
+        }
+    }
+    p_dst[code_pos] = code;
+
+    return out;
+}
+
+/**
+ * @brief COBS原地解码, 返回解码后的长度, 编码错误返回0
+ */
+static size_t __mux_cobs_decode (uint8_t *p_buf, size_t len)
+{
+    size_t  in = 0, out = 0;
+    uint8_t code, i;
+
+    while (in < len) {
+        code = p_buf[in++];
+        if ((code == 0) || (in + code - 1 > len)) {
+            return 0;
+        }
+
+        for (i = 1; i < code; i++) {
+            p_buf[out++] = p_buf[in++];
+        }
+
+        if ((code != 0xFF) && (in < len)) {
+            p_buf[out++] = 0;
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @brief 处理一个完整的帧
+ */
+static void __mux_frame (struct lm_serial_mux *p_mux)
+{
+    struct lm_serial_mux_chan *p_chan;
+    size_t                     len;
+
+    len = __mux_cobs_decode(p_mux->rx_frame, p_mux->rx_len);
+    if ((len < 2) || (__mux_crc8(p_mux->rx_frame, len - 1) != p_mux->rx_frame[len - 1])) {
+        p_mux->stat.crc_errors++;
+        return;
+    }
+
+    if ((p_mux->rx_frame[0] >= LM_SERIAL_MUX_CHAN_MAX) ||
+        ((p_chan = p_mux->chans[p_mux->rx_frame[0]]) == NULL)) {
+        p_mux->stat.unknown_chan++;
+        return;
+    }
+
+    p_mux->stat.frames++;
+
+    if (len > 2) {
+        lm_uart_port_rx_burst(&p_chan->port, &p_mux->rx_frame[1], len - 2);
+    }
+}
+
+/**
+ * @brief 解复用任务, 代替虚拟串口的接收中断
+ */
+static void __mux_rx_task (void *p_arg)
+{
+    struct lm_serial_mux *p_mux = (struct lm_serial_mux *)p_arg;
+    uint8_t               buf[LM_SERIAL_MUX_FRAME_MAX];
+    int                   len, i;
+
+    for (;;) {
+        len = lm_serial_read(p_mux->com, buf, sizeof(buf));
+        if (len <= 0) {
+            continue;
+        }
+
+        for (i = 0; i < len; i++) {
+            if (buf[i] == 0) {
+                if (p_mux->rx_len && !p_mux->rx_drop) {
+                    __mux_frame(p_mux);
+                }
+                p_mux->rx_len  = 0;
+                p_mux->rx_drop = 0;
+            } else if (p_mux->rx_len < sizeof(p_mux->rx_frame)) {
+                p_mux->rx_frame[p_mux->rx_len++] = buf[i];
+            } else if (!p_mux->rx_drop) {
+                p_mux->rx_drop = 1;
+                p_mux->stat.overflows++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 虚拟串口配置, 波特率等由物理串口决定
+ */
+static int __mux_set_config (struct lm_serial_port         *p_serial,
+                             const struct lm_serial_config *p_config)
+{
+    return LM_OK;
+}
+
+/**
+ * @brief 虚拟串口发送, 按MTU切分成帧写入物理串口
+ */
+static int __mux_send (struct lm_serial_port *p_serial,
+                       const void            *p_buf,
+                       size_t                 size)
+{
+    struct lm_serial_mux_chan *p_chan = __chan_from_port(p_serial);
+    const uint8_t             *p_data = (const uint8_t *)p_buf;
+    uint8_t                    raw[LM_SERIAL_MUX_RAW_MAX];
+    uint8_t                    frame[LM_SERIAL_MUX_FRAME_MAX + 1];
+    size_t                     sent = 0, chunk, len;
+    int                        ret;
+
+    while (sent < size) {
+        chunk = size - sent;
+        if (chunk > LM_SERIAL_MUX_MTU) {
+            chunk = LM_SERIAL_MUX_MTU;
+        }
+
+        raw[0] = p_chan->chan;
+        memcpy(&raw[1], &p_data[sent], chunk);
+        raw[chunk + 1] = __mux_crc8(raw, chunk + 1);
+
+        len        = __mux_cobs_encode(raw, chunk + 2, frame);
+        frame[len] = 0;
+
+        /* 每帧单独获取物理串口的写锁, 各通道的帧可以交错发送 */
+        ret = lm_serial_write(p_chan->p_mux->com, frame, len + 1);
+        if (ret < 0) {
+            return (sent > 0) ? (int)sent : ret;
+        }
+
+        sent += chunk;
+    }
+
+    return (int)sent;
+}
+
+/**
+ * @brief 虚拟串口发送一个字符
+ */
+static void __mux_poll_put_char (struct lm_serial_port *p_serial, uint8_t c)
+{
+    __mux_send(p_serial, &c, 1);
+}
+
+static const lm_serial_ops_t __g_mux_ops = {
+    .pfunc_set_config    = __mux_set_config,
+    .pfunc_send          = __mux_send,
+    .pfunc_poll_put_char = __mux_poll_put_char,
+};
+
+/**
+ * @brief 初始化复用器并启动解复用任务
+ *
+ * 清零整个复用器(包括已添加的通道), 只能在添加通道之前调用一次
+ */
+int lm_serial_mux_init (struct lm_serial_mux *p_mux, int com)
+{
+    struct lm_serial_info serial_info, old_info;
+    int                   ret;
+
+    if (p_mux == NULL) {
+        return -LM_EINVAL;
+    }
+
+    memset(p_mux, 0, sizeof(*p_mux));
+    p_mux->com = com;
+
+    /* 物理串口: 阻塞等待第一个字节, 之后按码间超时返回 */
+    ret = lm_serial_get_info(com, &old_info);
+    if (ret != LM_OK) {
+        return ret;
+    }
+
+    serial_info              = old_info;
+    serial_info.read_timeout = 0xFFFFFFFF;
+    serial_info.idle_timeout = LM_SERIAL_MUX_IDLE_MS;
+    ret = lm_serial_set_info(com, &serial_info);
+    if (ret != LM_OK) {
+        return ret;
+    }
+
+    if (lm_task_create("serial_mux", __mux_rx_task, LM_SERIAL_MUX_TASK_STACK,
+                       LM_SERIAL_MUX_TASK_PRIO, p_mux) != LM_TYPE_PASS) {
+        /* 物理串口恢复原来的超时配置 */
+        lm_serial_set_info(com, &old_info);
+        return -LM_ENOMEM;
+    }
+
+    return LM_OK;
+}
+
+/**
+ * @brief 添加逻辑通道
+ */
+int lm_serial_mux_add (struct lm_serial_mux      *p_mux,
+                       struct lm_serial_mux_chan *p_chan,
+                       uint8_t                    chan,
+                       int                        vcom,
+                       uint8_t                   *recv_buf,
+                       uint32_t                   buf_size)
+{
+    int ret;
+
+    if ((p_mux == NULL) || (p_chan == NULL) || (recv_buf == NULL) ||
+        (chan >= LM_SERIAL_MUX_CHAN_MAX) || (vcom == p_mux->com)) {
+        return -LM_EINVAL;
+    }
+
+    if (p_mux->chans[chan] != NULL) {
+        return -LM_EEXIST;
+    }
+
+    memset(p_chan, 0, sizeof(*p_chan));
+    p_chan->p_mux         = p_mux;
+    p_chan->chan          = chan;
+    p_chan->port.recv_buf = recv_buf;
+    p_chan->port.buf_size = buf_size;
+    p_chan->port.id       = vcom;
+    p_chan->port.p_ops    = &__g_mux_ops;
+
+    ret = lm_serial_register(&p_chan->port);
+    if (ret != LM_OK) {
+        return ret;
+    }
+
+    p_mux->chans[chan] = p_chan;
+
+    return LM_OK;
+}
+
+/* end of file */
@@ -3,8 +3,21 @@
 #include "string.h"
 
 
-/* 链表头 */
-LIST_HEAD(__g_spi_list);
+/* 按总线ID索引的控制器 */
+static lm_spi_master_t *__g_spi_master[LM_SPI_BUS_MAX] = {NULL};
+
+#if LM_SPI_DMA_BOUNCE_NUM >= 32
+#error "LM_SPI_DMA_BOUNCE_NUM must be less than 32, the free bitmap is a uint32_t"
+#endif
+
+#if LM_SPI_DMA_BOUNCE_NUM
+/* DMA弹跳缓存区池, 按缓存行对齐, 用户缓存区不能直接DMA时使用 */
+static uint8_t __g_spi_bounce[LM_SPI_DMA_BOUNCE_NUM][LM_SPI_DMA_BOUNCE_SIZE]
+                                                __aligned(LM_SPI_DMA_ALIGN);
+
+/* 空闲的弹跳缓存区, 第n位为1表示第n个空闲 */
+static uint32_t __g_spi_bounce_free = (uint32_t)(BIT(LM_SPI_DMA_BOUNCE_NUM) - 1);
+#endif
 
 /*
  * 片选
@@ -34,66 +47,539 @@ static int __spi_validate_bits_per_word (lm_spi_master_t *p_master,
 }
 
 /*
- * 传输一个消息
+ * 把设备的配置写入控制器, 在占有总线(busy)时调用
  */
-static int __spi_transfer_one_message (lm_spi_master_t  *p_master,
-                                       lm_spi_message_t *p_msg)
+static int __spi_apply (lm_spi_master_t *p_master, lm_spi_dev_t *p_spi)
 {
-    int                               ret;
-    lm_spi_transfer_t                *xfer;
-    uint8_t                          keep_cs = LM_FALSE;
+    int ret = LM_OK;
 
-    p_msg->status = -LM_EINPROGRESS;
+    if (p_master->p_funcs->pfunc_apply) {
+        ret = p_master->p_funcs->pfunc_apply(p_master, p_spi);
+    } else if (p_master->p_funcs->pfunc_setup) {
+        ret = p_master->p_funcs->pfunc_setup(p_master, p_spi);
+    }
+
+    p_master->p_spi  = p_spi;
+    p_spi->cfg_dirty = (ret != LM_OK);
+
+    return ret;
+}
+
+/*
+ * 开始传输一个消息, 设备切换时才重新配置控制器
+ */
+static int __spi_msg_start (lm_spi_master_t *p_master, lm_spi_message_t *p_msg)
+{
+    int ret = LM_OK;
+
+    p_master->p_cur_msg   = p_msg;
+    p_master->keep_cs     = LM_FALSE;
+    p_master->p_cur_xfer  = lm_list_first_entry(&p_msg->transfers,
+                                                lm_spi_transfer_t,
+                                                transfer_list);
+
+    p_msg->status         = -LM_EINPROGRESS;
+    p_msg->actual_length  = 0;
+
+    if ((p_master->p_spi != p_msg->p_spi) || p_msg->p_spi->cfg_dirty) {
+        ret = __spi_apply(p_master, p_msg->p_spi);
+        if (ret != LM_OK) {
+            return ret;
+        }
+    }
 
     __spi_set_cs(p_master, 1);
 
-    lm_list_for_each_entry(xfer, &p_msg->transfers, transfer_list) {
+    return ret;
+}
 
-        if (xfer->p_txbuf || xfer->p_rxbuf) {
-            if (p_master->p_funcs->pfunc_transfer) {
-                if((ret = p_master->p_funcs->pfunc_transfer(p_master,
-                                                            p_msg->p_spi,
-                                                            xfer))) {
-                    goto out;
-                }
-            }
+/*
+ * 结束当前消息, 调用完成回调
+ */
+static void __spi_msg_finish (lm_spi_master_t *p_master, int status)
+{
+    lm_spi_message_t *p_msg = p_master->p_cur_msg;
+
+    if ((status != LM_OK) || (!p_master->keep_cs)) {
+        __spi_set_cs(p_master, 0);
+    }
+
+    p_master->p_cur_msg = NULL;
+    p_msg->status       = status;
+
+    if (p_msg->pfunc_complete) {
+        p_msg->pfunc_complete(p_msg->p_arg);
+    }
+}
+
+/*
+ * 消息泵是否在中断中运行, 中断中不能忙等待delay_usece
+ */
+static inline bool __spi_in_isr (lm_spi_master_t *p_master)
+{
+    return p_master->in_isr || __lm_in_isr();
+}
+
+/*
+ * 当前传输完成, 处理延时和片选, 指向下一个传输
+ */
+static void __spi_xfer_next (lm_spi_master_t *p_master)
+{
+    lm_spi_message_t  *p_msg = p_master->p_cur_msg;
+    lm_spi_transfer_t *xfer  = p_master->p_cur_xfer;
+
+    if (xfer->delay_usece) {
+        lm_udelay(xfer->delay_usece);
+    }
+
+    if (xfer->cs_change) {
+        if (lm_list_is_last(&xfer->transfer_list, &p_msg->transfers)) {
+            p_master->keep_cs = LM_TRUE;
         } else {
-            if (xfer->len) {
-                //todo错误
-            }
+            __spi_set_cs(p_master, 0);
+
+            /* 延时10us */
+            __spi_set_cs(p_master, 1);
+        }
+    }
+
+    p_msg->actual_length += xfer->len;
+
+    p_master->p_cur_xfer = lm_list_entry(xfer->transfer_list.next,
+                                         lm_spi_transfer_t,
+                                         transfer_list);
+}
+
+/*
+ * 申请一个弹跳缓存区, 没有空闲时返回NULL
+ */
+static uint8_t *__spi_bounce_alloc (size_t len)
+{
+#if LM_SPI_DMA_BOUNCE_NUM
+    lm_base_t state;
+    uint8_t  *p_buf = NULL;
+    int       i;
+
+    if (len > LM_SPI_DMA_BOUNCE_SIZE) {
+        return NULL;
+    }
+
+    state = lm_critical_enter_isr();
+    for (i = 0; i < LM_SPI_DMA_BOUNCE_NUM; i++) {
+        if (__g_spi_bounce_free & BIT(i)) {
+            __g_spi_bounce_free &= ~BIT(i);
+            p_buf = __g_spi_bounce[i];
+            break;
+        }
+    }
+    lm_critical_exit_isr(state);
+
+    return p_buf;
+#else
+    return NULL;
+#endif
+}
+
+/*
+ * 释放弹跳缓存区
+ */
+static void __spi_bounce_free (uint8_t *p_buf)
+{
+#if LM_SPI_DMA_BOUNCE_NUM
+    lm_base_t state;
+
+    if (p_buf == NULL) {
+        return;
+    }
+
+    state = lm_critical_enter_isr();
+    __g_spi_bounce_free |= BIT((p_buf - __g_spi_bounce[0]) / LM_SPI_DMA_BOUNCE_SIZE);
+    lm_critical_exit_isr(state);
+#endif
+}
+
+/*
+ * 缓存区能否直接用于DMA: 地址按缓存行对齐; 接收时长度也要对齐,
+ * 无效化缓存不会影响相邻的数据. 发送只清理缓存, 长度不需要对齐
+ */
+static bool __spi_can_dma (lm_spi_master_t *p_master,
+                           const void      *p_buf,
+                           size_t           len,
+                           bool             rx)
+{
+    if (((uintptr_t)p_buf | (rx ? len : 0)) & (LM_SPI_DMA_ALIGN - 1)) {
+        return false;
+    }
+
+    if (p_master->p_funcs->pfunc_can_dma) {
+        return p_master->p_funcs->pfunc_can_dma(p_master, p_buf, len);
+    }
+
+    return true;
+}
+
+/*
+ * 为当前传输准备DMA缓存区, 不能直接DMA的缓存区换成弹跳缓存区
+ */
+static bool __spi_dma_map (lm_spi_master_t *p_master)
+{
+    lm_spi_transfer_t *xfer = p_master->p_run_xfer;
+    uint8_t           *p_tx = NULL, *p_rx = NULL;
+
+    if (xfer->p_txbuf && !__spi_can_dma(p_master, xfer->p_txbuf, xfer->len, false)) {
+        if ((p_tx = __spi_bounce_alloc(xfer->len)) == NULL) {
+            return false;
+        }
+        memcpy(p_tx, xfer->p_txbuf, xfer->len);
+    }
+
+    if (xfer->p_rxbuf && !__spi_can_dma(p_master, xfer->p_rxbuf, xfer->len, true)) {
+        if ((p_rx = __spi_bounce_alloc(xfer->len)) == NULL) {
+            __spi_bounce_free(p_tx);
+            return false;
+        }
+    }
+
+    p_master->dma_xfer        = *xfer;
+    p_master->p_dma_tx_bounce = p_tx;
+    p_master->p_dma_rx_bounce = p_rx;
+    p_master->dma_mapped      = LM_TRUE;
+
+    if (p_tx) {
+        p_master->dma_xfer.p_txbuf = p_tx;
+    }
+    if (p_rx) {
+        p_master->dma_xfer.p_rxbuf = p_rx;
+    }
+
+    return true;
+}
+
+/*
+ * DMA传输结束, 接收数据从弹跳缓存区拷贝回用户缓存区
+ */
+static void __spi_dma_unmap (lm_spi_master_t *p_master, int status)
+{
+    lm_spi_transfer_t *xfer = p_master->p_run_xfer;
+
+    if (p_master->p_dma_rx_bounce && (status == LM_OK)) {
+        memcpy(xfer->p_rxbuf, p_master->p_dma_rx_bounce, xfer->len);
+    }
+
+    __spi_bounce_free(p_master->p_dma_tx_bounce);
+    __spi_bounce_free(p_master->p_dma_rx_bounce);
+
+    p_master->p_dma_tx_bounce = NULL;
+    p_master->p_dma_rx_bounce = NULL;
+    p_master->dma_mapped      = LM_FALSE;
+}
+
+#if LM_SPI_COALESCE_MAX
+/*
+ * 传输能否参与合并: 单线传输, 有数据缓存区
+ */
+static inline bool __spi_xfer_mergeable (const lm_spi_transfer_t *xfer)
+{
+    return (xfer->tx_nbits <= LM_SPI_NBITS_SINGLE) &&
+           (xfer->rx_nbits <= LM_SPI_NBITS_SINGLE) &&
+           (xfer->p_txbuf || xfer->p_rxbuf);
+}
+
+/*
+ * 从当前传输开始, 把字长和速度相同, 中间没有延时和片选变化的短传输
+ * 合并成一个传输. 发送数据拼接到merge_tx, 只接收的段发送0xff,
+ * 接收数据先收到merge_rx, 完成后拷贝回各个传输. merge_tx/merge_rx按
+ * LM_SPI_DMA_ALIGN对齐, 合并后达到DMA门限时可以直接用于DMA.
+ *
+ * 驱动按pfunc_transfer的约定在只接收时发送0xff, 合并后线上的数据和逐个传输相同.
+ * 返回合并的传输个数, 不合并时返回0
+ */
+static int __spi_coalesce (lm_spi_master_t *p_master)
+{
+    lm_spi_message_t  *p_msg  = p_master->p_cur_msg;
+    lm_spi_dev_t      *p_spi  = p_msg->p_spi;
+    lm_spi_transfer_t *first  = p_master->p_cur_xfer;
+    lm_spi_transfer_t *merged = &p_master->merge_xfer;
+    lm_spi_transfer_t *xfer, *prev = NULL;
+    size_t             total  = 0;
+    bool               has_rx = false;
+    int                cnt    = 0, i;
+
+    /* 合并后需要同时收发 */
+    if ((p_spi->flags & LM_SPI_MASTER_HALF_DUPLEX) || (p_spi->mode & LM_SPI_3WIRE)) {
+        return 0;
+    }
+
+    for (xfer = first;
+         &xfer->transfer_list != &p_msg->transfers;
+         xfer = lm_list_entry(xfer->transfer_list.next, lm_spi_transfer_t, transfer_list)) {
+
+        /* 带延时的传输单独传输, 见__spi_xfer_start() */
+        if (!__spi_xfer_mergeable(xfer) || xfer->delay_usece ||
+            (total + xfer->len > LM_SPI_COALESCE_MAX)) {
+            break;
+        }
+
+        if (prev && ((prev->bits_per_word != xfer->bits_per_word) ||
+                     (prev->speed_hz != xfer->speed_hz) ||
+                     prev->cs_change)) {
+            break;
+        }
+
+        total  += xfer->len;
+        has_rx |= (xfer->p_rxbuf != NULL);
+        prev    = xfer;
+        cnt++;
+    }
+
+    if (cnt < 2) {
+        return 0;
+    }
+
+    /* 拼接发送数据 */
+    total = 0;
+    for (i = 0, xfer = first; i < cnt; i++) {
+        if (xfer->p_txbuf) {
+            memcpy(&p_master->merge_tx[total], xfer->p_txbuf, xfer->len);
+        } else {
+            memset(&p_master->merge_tx[total], 0xff, xfer->len);
+        }
+        total += xfer->len;
+        xfer   = lm_list_entry(xfer->transfer_list.next, lm_spi_transfer_t, transfer_list);
+    }
+
+    *merged             = *first;
+    merged->p_txbuf     = p_master->merge_tx;
+    merged->p_rxbuf     = has_rx ? p_master->merge_rx : NULL;
+    merged->len         = total;
+    merged->cs_change   = 0;
+    merged->delay_usece = 0;
+
+    p_master->merge_cnt = cnt;
+
+    return cnt;
+}
+
+/*
+ * 合并传输结束, 接收数据拷贝回各个传输, 返回合并的传输个数
+ */
+static int __spi_uncoalesce (lm_spi_master_t *p_master, int status)
+{
+    lm_spi_transfer_t *xfer   = p_master->p_cur_xfer;
+    size_t             offset = 0;
+    int                cnt    = p_master->merge_cnt, i;
+
+    for (i = 0; i < cnt; i++) {
+        if ((status == LM_OK) && xfer->p_rxbuf) {
+            memcpy(xfer->p_rxbuf, &p_master->merge_rx[offset], xfer->len);
         }
+        offset += xfer->len;
+        xfer    = lm_list_entry(xfer->transfer_list.next, lm_spi_transfer_t, transfer_list);
+    }
 
-        /* 一次传输完成 */
-        if (p_msg->status != -LM_EINPROGRESS) {
-            goto out;
+    p_master->merge_cnt = 0;
+
+    return cnt;
+}
+#endif
+
+/*
+ * 启动当前传输
+ *
+ * 带delay_usece的传输只在任务中用PIO传输, 延时在任务中忙等待;
+ * 消息泵在中断中运行时拒绝, 消息以-LM_ENOTSUP结束
+ */
+static int __spi_xfer_start (lm_spi_master_t *p_master)
+{
+    lm_spi_transfer_t *xfer = p_master->p_cur_xfer;
+    size_t             threshold;
+    int                ret;
+
+    if (xfer->delay_usece && __spi_in_isr(p_master)) {
+        return -LM_ENOTSUP;
+    }
+
+    if (xfer->p_txbuf || xfer->p_rxbuf) {
+
+#if LM_SPI_COALESCE_MAX
+        /* 多个短传输合并成一次控制器操作 */
+        if (__spi_coalesce(p_master)) {
+            xfer = &p_master->merge_xfer;
+        }
+#endif
+        p_master->p_run_xfer = xfer;
+
+        /* 长传输使用DMA, 短传输的DMA配置开销大于传输时间, 使用PIO */
+        threshold = p_master->dma_threshold ? p_master->dma_threshold :
+                                              LM_SPI_DMA_THRESHOLD;
+        if (p_master->p_funcs->pfunc_transfer_dma && (xfer->len >= threshold) &&
+            !xfer->delay_usece && __spi_dma_map(p_master)) {
+            ret = p_master->p_funcs->pfunc_transfer_dma(p_master,
+                                                        p_master->p_cur_msg->p_spi,
+                                                        &p_master->dma_xfer);
+            if (ret != -LM_EINPROGRESS) {
+                __spi_dma_unmap(p_master, ret);
+            }
+            return ret;
         }
 
-        if (xfer->delay_usece) {
-            lm_udelay(xfer->delay_usece);
+        /* 没有DMA或弹跳缓存区不够时使用PIO */
+        if (p_master->p_funcs->pfunc_transfer) {
+            return p_master->p_funcs->pfunc_transfer(p_master,
+                                                     p_master->p_cur_msg->p_spi,
+                                                     xfer);
         }
+    } else {
+        if (xfer->len) {
+            //todo错误
+        }
+    }
+
+    return LM_OK;
+}
 
-        if (xfer->cs_change) {
-            if (lm_list_is_last(&xfer->transfer_list, &p_msg->transfers)) {
-                keep_cs = LM_TRUE;
-            } else {
-                __spi_set_cs(p_master, 0);
+/*
+ * 当前传输结束, 出错或驱动设置了消息状态时结束整个消息
+ */
+static void __spi_xfer_complete (lm_spi_master_t *p_master, int status)
+{
+    lm_spi_message_t *p_msg = p_master->p_cur_msg;
+    int               cnt   = 1;
+
+    if (p_master->dma_mapped) {
+        __spi_dma_unmap(p_master, status);
+    }
+
+#if LM_SPI_COALESCE_MAX
+    if (p_master->merge_cnt) {
+        cnt = __spi_uncoalesce(p_master, status);
+    }
+#endif
 
-                /* 延时10us */
-                __spi_set_cs(p_master, 1);
+    if ((status == LM_OK) && p_master->p_cur_xfer->delay_usece &&
+        __spi_in_isr(p_master)) {
+        /* 驱动在中断中完成了带延时的传输, 不在中断中忙等待 */
+        status = -LM_ENOTSUP;
+    }
+
+    if (status != LM_OK) {
+        __spi_msg_finish(p_master, status);
+    } else if (p_msg->status != -LM_EINPROGRESS) {
+        /* 驱动在传输中设置了消息状态, 提前结束 */
+        __spi_msg_finish(p_master, p_msg->status);
+    } else {
+        /* 合并的传输逐个处理延时, 片选和长度 */
+        while (cnt--) {
+            __spi_xfer_next(p_master);
+        }
+    }
+}
+
+/*
+ * 消息泵: 连续传输队列中的消息, 直到队列为空
+ *
+ * 由提交消息的任务或者传输完成中断运行, 同一时刻只有一个上下文在运行;
+ * 驱动返回-LM_EINPROGRESS时退出, 传输完成中断中调用
+ * lm_spi_transfer_done()继续, 消息之间不需要任务切换
+ */
+static void __spi_pump (lm_spi_master_t *p_master)
+{
+    lm_spi_message_t *p_msg;
+    lm_base_t         state;
+    int               ret;
+
+    for (;;) {
+        p_msg = p_master->p_cur_msg;
+
+        /* 取下一个消息 */
+        if (p_msg == NULL) {
+            state = lm_critical_enter_isr();
+            if (lm_list_empty(&p_master->queue)) {
+                p_master->busy = LM_FALSE;
+                lm_critical_exit_isr(state);
+                return;
             }
+            p_msg = lm_list_first_entry(&p_master->queue, lm_spi_message_t, queue);
+            lm_list_del_init(&p_msg->queue);
+            lm_critical_exit_isr(state);
+
+            ret = __spi_msg_start(p_master, p_msg);
+            if (ret != LM_OK) {
+                __spi_msg_finish(p_master, ret);
+                continue;
+            }
+        }
+
+        /* 所有传输已完成 */
+        if (&p_master->p_cur_xfer->transfer_list == &p_msg->transfers) {
+            __spi_msg_finish(p_master, LM_OK);
+            continue;
+        }
+
+        ret = __spi_xfer_start(p_master);
+        if (ret == -LM_EINPROGRESS) {
+            return;
         }
 
-        p_msg->actual_length += xfer->len;
+        __spi_xfer_complete(p_master, ret);
     }
+}
 
-out:
-    if ((ret != 0) || (!keep_cs)) {
-        __spi_set_cs(p_master, 0);
+/*
+ * 一次传输完成(驱动在传输完成中断中调用)
+ */
+void lm_spi_transfer_done (lm_spi_master_t *p_master, int status)
+{
+    p_master->in_isr = LM_TRUE;
+    __spi_xfer_complete(p_master, status);
+    __spi_pump(p_master);
+    p_master->in_isr = LM_FALSE;
+}
+
+/*
+ * 消息加入控制器队列, 总线空闲时在当前上下文中开始传输
+ */
+static int __spi_async (lm_spi_master_t  *p_master,
+                        lm_spi_dev_t     *p_spi,
+                        lm_spi_message_t *p_msg)
+{
+    lm_base_t        state;
+    lm_task_handle_t self;
+    uint8_t          start;
+
+    /* 中断不会是总线的持有者, 中断中取到的是被打断的任务, 不能用来比较 */
+    self = __lm_in_isr() ? NULL : lm_task_self();
+
+    /* 检查和入队在同一个临界区内, 检查之后其他任务不能再独占总线 */
+    state = lm_critical_enter_isr();
+    if ((p_master->bus_owner != NULL) && (p_master->bus_owner != self)) {
+        lm_critical_exit_isr(state);
+        return -LM_EBUSY;
+    }
+    p_msg->p_spi    = p_spi;
+    p_msg->p_master = p_master;
+    p_msg->status   = -LM_EINPROGRESS;
+    lm_list_add_tail(&p_msg->queue, &p_master->queue);
+    start = !p_master->busy;
+    p_master->busy = LM_TRUE;
+    lm_critical_exit_isr(state);
+
+    if (start) {
+        __spi_pump(p_master);
     }
 
-    return ret;
+    return LM_OK;
 }
 
+/*
+ * 同步传输完成回调
+ */
+static void __spi_sync_complete (void *p_arg)
+{
+    lm_spi_master_t *p_master = (lm_spi_master_t *)p_arg;
+
+    lm_semb_give(&p_master->sync_semb);
+}
 
 /*
  * 同步传输
@@ -102,33 +588,35 @@ static int __spi_sync (lm_spi_master_t  *p_master,
                        lm_spi_dev_t     *p_spi,
                        lm_spi_message_t *p_msg)
 {
+    int ret;
 
-    int                      ret = LM_OK;
+    p_msg->pfunc_complete = __spi_sync_complete;
+    p_msg->p_arg          = p_master;
 
-    ret = __spi_transfer_one_message(p_master, p_msg);
+    ret = __spi_async(p_master, p_spi, p_msg);
+    if (ret == LM_OK) {
+        /* 总线空闲时消息已经在当前任务中传输完成, 不会阻塞 */
+        lm_semb_take(&p_master->sync_semb, LM_SEM_WAIT_FOREVER);
+        ret = p_msg->status;
+    }
 
     return ret;
 }
 
 /*
- * 查找 SPI 控制器
+ * 查找 SPI 控制器, 设置过的设备直接使用解析好的控制器
  */
-static lm_spi_master_t *__find_spi_master (lm_spi_dev_t *p_spi)
+static inline lm_spi_master_t *__find_spi_master (lm_spi_dev_t *p_spi)
 {
+    if (p_spi->p_master) {
+        return p_spi->p_master;
+    }
 
-    struct lm_list_head *p_node = __g_spi_list.next;
-    lm_spi_master_t     *p_master = NULL;
-
-    while(p_node != &__g_spi_list) {
-        p_master = lm_list_entry(p_node, lm_spi_master_t, list);
-
-        if (p_spi->bus_id == p_master->bus_id) {
-            return p_master;
-        }
-        p_node = p_node->next;
+    if (p_spi->bus_id >= LM_SPI_BUS_MAX) {
+        return NULL;
     }
 
-    return NULL;
+    return __g_spi_master[p_spi->bus_id];
 }
 
 /*
@@ -138,17 +626,18 @@ int lm_spi_setup (lm_spi_dev_t *p_spi)
 {
     int                ret = LM_OK;
     uint32_t           bad_bits;
+    lm_base_t          state;
+    uint8_t            claimed;
 
     lm_spi_master_t *p_master = NULL;
 
+    /* 总线ID可能被修改过, 重新解析 */
+    p_spi->p_master = NULL;
     p_master = __find_spi_master(p_spi);
     if (!p_master){
         return -LM_ENODEV;
     }
 
-    /* 设置控制器中SPI设备指针 */
-    p_master->p_spi = p_spi;
-
     if (((p_spi->mode & LM_SPI_TX_DUAL) && (p_spi->mode & LM_SPI_TX_QUAD)) ||
         ((p_spi->mode & LM_SPI_RX_DUAL) && (p_spi->mode & LM_SPI_RX_QUAD))) {
         return -LM_EINVAL;
@@ -178,12 +667,31 @@ int lm_spi_setup (lm_spi_dev_t *p_spi)
         return ret;
     }
 
-    if (p_master->p_funcs->pfunc_setup) {
-        ret  = p_master->p_funcs->pfunc_setup(p_master, p_spi);
+    p_spi->p_master = p_master;
+
+    /* 预先计算配置, 不访问控制器 */
+    if (p_master->p_funcs->pfunc_apply && p_master->p_funcs->pfunc_setup) {
+        if ((ret = p_master->p_funcs->pfunc_setup(p_master, p_spi))) {
+            return ret;
+        }
     }
+    p_spi->cfg_dirty = LM_TRUE;
 
-    /* 关闭片选 */
-    __spi_set_cs(p_master, 0);
+    /* 总线空闲时立即生效并关闭片选, 否则在该设备的下一个消息前生效 */
+    state   = lm_critical_enter_isr();
+    claimed = !p_master->busy;
+    p_master->busy = LM_TRUE;
+    lm_critical_exit_isr(state);
+
+    if (claimed) {
+        ret = __spi_apply(p_master, p_spi);
+
+        /* 关闭片选 */
+        __spi_set_cs(p_master, 0);
+
+        /* 传输占有总线期间加入的消息, 没有消息时释放总线 */
+        __spi_pump(p_master);
+    }
 
     /* todo: debug */
 
@@ -204,16 +712,83 @@ int lm_spi_sync (lm_spi_dev_t     *p_spi,
         return -LM_ENODEV;
     }
 
-    p_msg->p_spi = p_spi;
+    /* 已经通过lm_spi_bus_lock()独占总线时不再加锁 */
+    if (p_master->bus_owner == lm_task_self()) {
+        return __spi_sync(p_master, p_spi, p_msg);
+    }
 
     lm_mutex_lock(&p_master->bus_lock_mutex, LM_SEM_WAIT_FOREVER);
-    p_master->p_spi = p_spi;
     ret = __spi_sync(p_master, p_spi, p_msg);
     lm_mutex_unlock(&p_master->bus_lock_mutex);
 
     return ret;
 }
 
+/*
+ * 独占总线
+ */
+int lm_spi_bus_lock (lm_spi_dev_t *p_spi)
+{
+    lm_spi_master_t *p_master = NULL;
+    lm_base_t        state;
+
+    p_master = __find_spi_master(p_spi);
+    if (!p_master){
+        return -LM_ENODEV;
+    }
+
+    lm_mutex_lock(&p_master->bus_lock_mutex, LM_SEM_WAIT_FOREVER);
+
+    /* 与__spi_async()的检查互斥 */
+    state = lm_critical_enter_isr();
+    p_master->bus_owner = lm_task_self();
+    lm_critical_exit_isr(state);
+
+    return LM_OK;
+}
+
+/*
+ * 释放总线
+ */
+int lm_spi_bus_unlock (lm_spi_dev_t *p_spi)
+{
+    lm_spi_master_t *p_master = NULL;
+    lm_base_t        state;
+
+    p_master = __find_spi_master(p_spi);
+    if (!p_master){
+        return -LM_ENODEV;
+    }
+
+    state = lm_critical_enter_isr();
+    if (p_master->bus_owner != lm_task_self()) {
+        lm_critical_exit_isr(state);
+        return -LM_EINVAL;
+    }
+    p_master->bus_owner = NULL;
+    lm_critical_exit_isr(state);
+
+    lm_mutex_unlock(&p_master->bus_lock_mutex);
+
+    return LM_OK;
+}
+
+/*
+ * SPI 异步传输
+ */
+int lm_spi_async (lm_spi_dev_t     *p_spi,
+                  lm_spi_message_t *p_msg)
+{
+    lm_spi_master_t *p_master = NULL;
+
+    p_master = __find_spi_master(p_spi);
+    if (!p_master){
+        return -LM_ENODEV;
+    }
+
+    return __spi_async(p_master, p_spi, p_msg);
+}
+
 /*
  * 先写后读
  */
@@ -257,10 +832,34 @@ int lm_spi_register (lm_spi_master_t *p_master)
 {
     int ret = LM_OK;
 
+    if ((p_master == NULL) || (p_master->bus_id < 0) ||
+        (p_master->bus_id >= LM_SPI_BUS_MAX)) {
+        return -LM_EINVAL;
+    }
+
+    if (__g_spi_master[p_master->bus_id] != NULL) {
+        return -LM_EEXIST;
+    }
+
     /* 创建同步锁 */
     lm_mutex_create(&p_master->bus_lock_mutex);
-
-    lm_list_add_tail(&p_master->list , &__g_spi_list);
+    lm_semb_create(&p_master->sync_semb);
+
+    /* 消息队列 */
+    LM_INIT_LIST_HEAD(&p_master->queue);
+    p_master->p_cur_msg  = NULL;
+    p_master->p_cur_xfer = NULL;
+    p_master->p_run_xfer = NULL;
+#if LM_SPI_COALESCE_MAX
+    p_master->merge_cnt  = 0;
+#endif
+    p_master->busy       = LM_FALSE;
+    p_master->dma_mapped = LM_FALSE;
+    p_master->in_isr     = LM_FALSE;
+    p_master->bus_owner  = NULL;
+    p_master->p_spi      = NULL;
+
+    __g_spi_master[p_master->bus_id] = p_master;
 
     return ret;
 }
@@ -0,0 +1,189 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_kfifo.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 大容量环形缓冲区模块(容量为2的幂)
+*******************************************************************************/
+
+#include "lm_kfifo.h"
+#include "lmiracle.h"
+#include "lm_atomic.h"
+#include <string.h>
+
+/**
+ * @brief 从计数index处开始写入数据
+ */
+static void __kfifo_copy_in (struct lm_kfifo *p_fifo,
+                             uint32_t         index,
+                             const uint8_t   *ptr,
+                             size_t           length)
+{
+    size_t offset = index & p_fifo->mask;
+    size_t tail   = (size_t)p_fifo->mask + 1 - offset;
+
+    if (tail >= length) {
+        memcpy(&p_fifo->buffer[offset], ptr, length);
+        return;
+    }
+
+    memcpy(&p_fifo->buffer[offset], &ptr[0], tail);
+    memcpy(&p_fifo->buffer[0], &ptr[tail], length - tail);
+}
+
+/**
+ * @brief 从计数index处开始读出数据
+ */
+static void __kfifo_copy_out (struct lm_kfifo *p_fifo,
+                              uint32_t         index,
+                              uint8_t         *ptr,
+                              size_t           length)
+{
+    size_t offset = index & p_fifo->mask;
+    size_t tail   = (size_t)p_fifo->mask + 1 - offset;
+
+    if (tail >= length) {
+        memcpy(ptr, &p_fifo->buffer[offset], length);
+        return;
+    }
+
+    memcpy(&ptr[0], &p_fifo->buffer[offset], tail);
+    memcpy(&ptr[tail], &p_fifo->buffer[0], length - tail);
+}
+
+/**
+ * @brief 初始化kfifo
+ */
+int lm_kfifo_init (struct lm_kfifo *p_fifo, uint8_t *pool, size_t size)
+{
+    /* 1.参数检查, 容量必须是2的幂且计数差值能用32位表示 */
+    if (unlikely(NULL == p_fifo || NULL == pool || size < 2)) {
+        return -LM_EINVAL;
+    }
+
+    if ((size & (size - 1)) || (size > 0x80000000UL)) {
+        return -LM_EINVAL;
+    }
+
+    p_fifo->buffer = pool;
+    p_fifo->mask   = size - 1;
+    lm_atomic_store_relaxed(&p_fifo->out, 0);
+    lm_atomic_store_release(&p_fifo->in, 0);
+
+    return LM_OK;
+}
+
+/**
+ * @brief 写入数据
+ */
+size_t lm_kfifo_in (struct lm_kfifo *p_fifo, const void *ptr, size_t length)
+{
+    uint32_t in, out;
+    size_t   space;
+
+    if (p_fifo == NULL || ptr == NULL) {
+        return 0;
+    }
+
+    /* out由消费者发布, in只有生产者自己修改 */
+    out = lm_atomic_load_acquire(&p_fifo->out);
+    in  = lm_atomic_load_relaxed(&p_fifo->in);
+
+    space = (size_t)p_fifo->mask + 1 - (uint32_t)(in - out);
+    if (space < length)
+        length = space;
+
+    __kfifo_copy_in(p_fifo, in, ptr, length);
+
+    /* 数据写完后再发布in */
+    lm_atomic_store_release(&p_fifo->in, in + (uint32_t)length);
+
+    return length;
+}
+
+/**
+ * @brief 查看数据
+ */
+size_t lm_kfifo_out_peek (struct lm_kfifo *p_fifo, void *ptr, size_t length)
+{
+    uint32_t in, out;
+    size_t   size;
+
+    if (p_fifo == NULL || ptr == NULL) {
+        return 0;
+    }
+
+    /* in由生产者发布, out只有消费者自己修改 */
+    in  = lm_atomic_load_acquire(&p_fifo->in);
+    out = lm_atomic_load_relaxed(&p_fifo->out);
+
+    size = (uint32_t)(in - out);
+    if (size < length)
+        length = size;
+
+    __kfifo_copy_out(p_fifo, out, ptr, length);
+
+    return length;
+}
+
+/**
+ * @brief 读出数据
+ */
+size_t lm_kfifo_out (struct lm_kfifo *p_fifo, void *ptr, size_t length)
+{
+    length = lm_kfifo_out_peek(p_fifo, ptr, length);
+
+    if (length) {
+        /* 数据读完后再发布out, 之后生产者才可以覆盖这段空间 */
+        lm_atomic_store_release(&p_fifo->out,
+                                lm_atomic_load_relaxed(&p_fifo->out) +
+                                (uint32_t)length);
+    }
+
+    return length;
+}
+
+/**
+ * @brief 获取kfifo中数据的长度
+ */
+size_t lm_kfifo_len (struct lm_kfifo *p_fifo)
+{
+    uint32_t in, out;
+    size_t   len;
+
+    if (p_fifo == NULL) {
+        return 0;
+    }
+
+    out = lm_atomic_load_acquire(&p_fifo->out);
+    in  = lm_atomic_load_acquire(&p_fifo->in);
+    len = (uint32_t)(in - out);
+
+    /* 两个计数不是同时读到的, 在第三方上下文中查询时可能略大于容量 */
+    if (len > (size_t)p_fifo->mask + 1)
+        len = (size_t)p_fifo->mask + 1;
+
+    return len;
+}
+
+/**
+ * @brief 复位kfifo
+ */
+void lm_kfifo_reset (struct lm_kfifo *p_fifo)
+{
+    if (p_fifo == NULL) {
+        return;
+    }
+
+    lm_atomic_store_relaxed(&p_fifo->out, 0);
+    lm_atomic_store_release(&p_fifo->in, 0);
+}
+
+/* end of file */
@@ -7,6 +7,7 @@
 * Change Logs   :
 * Date          Author          Notes
 * 2019-06-07    linxuew         V1.0    first version
+* 2026-10-17    agent           V1.1    SPSC lock-free indices
 *******************************************************************************/
 
 /*******************************************************************************
@@ -15,18 +16,219 @@
 
 #include "lm_ringbuf.h"
 #include "lmiracle.h"
+#include "lm_atomic.h"
 #include <string.h>
 
-static inline enum lm_ringbuf_state lm_ringbuf_status(struct lm_ringbuf *p_rb)
+/**
+ * @brief 索引转换为缓冲区中的偏移
+ */
+static inline uint32_t __ringbuf_offset (struct lm_ringbuf *p_rb, uint32_t index)
 {
-    if (p_rb->read_index == p_rb->write_index)
-    {
-        if (p_rb->read_mirror == p_rb->write_mirror)
-            return LM_RINGBUF_EMPTY;
-        else
-            return LM_RINGBUF_FULL;
+    if (index >= (uint32_t)p_rb->buffer_size)
+        return index - p_rb->buffer_size;
+    return index;
+}
+
+/**
+ * @brief 索引前进length个字节(跨过镜像末尾时回绕)
+ */
+static inline uint32_t __ringbuf_advance (struct lm_ringbuf *p_rb,
+                                          uint32_t           index,
+                                          uint32_t           length)
+{
+    index += length;
+    if (index >= 2u * p_rb->buffer_size)
+        index -= 2u * p_rb->buffer_size;
+    return index;
+}
+
+/**
+ * @brief 读索引到写索引之间的数据长度
+ */
+static inline uint32_t __ringbuf_distance (struct lm_ringbuf *p_rb,
+                                           uint32_t           read_index,
+                                           uint32_t           write_index)
+{
+    if (write_index >= read_index)
+        return write_index - read_index;
+    return 2u * p_rb->buffer_size - (read_index - write_index);
+}
+
+/**
+ * @brief 从索引index处开始写入数据(不发布写索引)
+ */
+static void __ringbuf_copy_in (struct lm_ringbuf *p_rb,
+                               uint32_t           index,
+                               const uint8_t     *ptr,
+                               uint32_t           length)
+{
+    uint32_t offset = __ringbuf_offset(p_rb, index);
+    uint32_t tail   = p_rb->buffer_size - offset;
+
+    if (tail >= length) {
+        memcpy(&p_rb->buffer_ptr[offset], ptr, length);
+        return;
     }
-    return LM_RINGBUF_HALFFULL;
+
+    memcpy(&p_rb->buffer_ptr[offset], &ptr[0], tail);
+    memcpy(&p_rb->buffer_ptr[0], &ptr[tail], length - tail);
+}
+
+/**
+ * @brief 从索引index处开始读出数据(不发布读索引)
+ */
+static void __ringbuf_copy_out (struct lm_ringbuf *p_rb,
+                                uint32_t           index,
+                                uint8_t           *ptr,
+                                uint32_t           length)
+{
+    uint32_t offset = __ringbuf_offset(p_rb, index);
+    uint32_t tail   = p_rb->buffer_size - offset;
+
+    if (tail >= length) {
+        memcpy(ptr, &p_rb->buffer_ptr[offset], length);
+        return;
+    }
+
+    memcpy(&ptr[0], &p_rb->buffer_ptr[offset], tail);
+    memcpy(&ptr[tail], &p_rb->buffer_ptr[0], length - tail);
+}
+
+#if LM_RINGBUF_STAT_ENABLED
+/**
+ * @brief 统计写入(生产者): 写入length字节, 丢弃dropped字节, 写入后数据长度为used
+ */
+static inline void __ringbuf_stat_in (struct lm_ringbuf *p_rb,
+                                      uint32_t           length,
+                                      uint32_t           dropped,
+                                      uint32_t           used)
+{
+    p_rb->stat.total_in += length;
+    p_rb->stat.dropped  += dropped;
+    if (used > p_rb->stat.high_water)
+        p_rb->stat.high_water = used;
+}
+
+/**
+ * @brief 统计覆盖(生产者)
+ */
+static inline void __ringbuf_stat_overwrite (struct lm_ringbuf *p_rb,
+                                             uint32_t           length)
+{
+    if (length) {
+        p_rb->stat.overwrite_count++;
+        p_rb->stat.overwritten += length;
+    }
+}
+
+/**
+ * @brief 统计强制写时因超过缓冲区容量而被截掉的输入(生产者)
+ */
+static inline void __ringbuf_stat_truncate (struct lm_ringbuf *p_rb,
+                                            uint32_t           length)
+{
+    p_rb->stat.truncated += length;
+}
+
+/**
+ * @brief 统计读出(消费者)
+ */
+static inline void __ringbuf_stat_out (struct lm_ringbuf *p_rb, uint32_t length)
+{
+    p_rb->stat.total_out += length;
+}
+#else
+#define __ringbuf_stat_in(p_rb, length, dropped, used)  do { } while (0)
+#define __ringbuf_stat_overwrite(p_rb, length)          do { } while (0)
+#define __ringbuf_stat_truncate(p_rb, length)           do { } while (0)
+#define __ringbuf_stat_out(p_rb, length)                do { } while (0)
+#endif
+
+/**
+ * @brief 生产者获取读索引
+ *
+ * 消费者还没有同步最近一次覆盖时, 它的读索引已经失效, 按缓冲区已满处理
+ */
+static inline uint32_t __ringbuf_producer_read_index (struct lm_ringbuf *p_rb,
+                                                      uint32_t           write_index)
+{
+    if (lm_atomic_load_acquire(&p_rb->overrun_ack) !=
+        lm_atomic_load_relaxed(&p_rb->overrun_seq))
+        return __ringbuf_advance(p_rb, write_index, p_rb->buffer_size);
+
+    return lm_atomic_load_acquire(&p_rb->read_index);
+}
+
+/**
+ * @brief 生产者开始覆盖未读数据, 覆盖序号变为奇数
+ */
+static inline void __ringbuf_overrun_begin (struct lm_ringbuf *p_rb)
+{
+    lm_atomic_store_relaxed(&p_rb->overrun_seq,
+                            lm_atomic_load_relaxed(&p_rb->overrun_seq) + 1);
+
+    /* 覆盖序号先于被覆盖的数据对消费者可见 */
+    lm_atomic_fence_release();
+}
+
+/**
+ * @brief 生产者结束覆盖: 发布写索引, 覆盖序号恢复为偶数
+ */
+static inline void __ringbuf_overrun_end (struct lm_ringbuf *p_rb,
+                                          uint32_t           write_index)
+{
+    lm_atomic_store_release(&p_rb->write_index, write_index);
+    lm_atomic_store_release(&p_rb->overrun_seq,
+                            lm_atomic_load_relaxed(&p_rb->overrun_seq) + 1);
+}
+
+/**
+ * @brief 消费者获取读写索引, 生产者覆盖过未读数据时先重新同步读索引
+ *
+ * @return 本次读取依据的覆盖序号, 奇数表示生产者正在覆盖(读写索引相同, 按没有数据处理)
+ */
+static inline uint32_t __ringbuf_consumer_begin (struct lm_ringbuf *p_rb,
+                                                 uint32_t          *p_read_index,
+                                                 uint32_t          *p_write_index)
+{
+    uint32_t seq, write_index;
+
+    /* 写索引和覆盖序号必须属于同一次覆盖之后 */
+    do {
+        seq = lm_atomic_load_acquire(&p_rb->overrun_seq);
+        if (seq & 1) {
+            /* 读写索引取相同的值, 调用者看到的是空缓冲区 */
+            *p_read_index  = lm_atomic_load_relaxed(&p_rb->read_index);
+            *p_write_index = *p_read_index;
+            return seq;
+        }
+
+        write_index = lm_atomic_load_acquire(&p_rb->write_index);
+    } while (lm_atomic_load_relaxed(&p_rb->overrun_seq) != seq);
+
+    /* 最早的数据已被覆盖, 从最新的一整圈数据开始读 */
+    if (seq != lm_atomic_load_relaxed(&p_rb->overrun_ack)) {
+        lm_atomic_store_relaxed(&p_rb->read_index,
+                                __ringbuf_advance(p_rb, write_index,
+                                                  p_rb->buffer_size));
+        lm_atomic_store_release(&p_rb->overrun_ack, seq);
+    }
+
+    *p_read_index  = lm_atomic_load_relaxed(&p_rb->read_index);
+    *p_write_index = write_index;
+
+    return seq;
+}
+
+/**
+ * @brief 消费者确认读出的数据在拷贝期间没有被生产者覆盖
+ */
+static inline bool __ringbuf_consumer_valid (struct lm_ringbuf *p_rb, uint32_t seq)
+{
+    /* 数据的读取不能被推迟到覆盖序号的检查之后 */
+    lm_atomic_fence_acquire();
+
+    return lm_atomic_load_relaxed(&p_rb->overrun_seq) == seq;
 }
 
 int lm_ringbuf_init (struct lm_ringbuf *p_rb, uint8_t *pool, size_t size)
@@ -36,10 +238,20 @@ int lm_ringbuf_init (struct lm_ringbuf *p_rb, uint8_t *pool, size_t size)
         return -LM_EINVAL;
     }
 
-    p_rb->read_mirror = p_rb->read_index = 0;
-    p_rb->write_mirror = p_rb->write_index = 0;
+    /* buffer_size为int16_t, 更大的缓冲区请使用lm_kfifo */
+    if (size > INT16_MAX) {
+        return -LM_EINVAL;
+    }
+
     p_rb->buffer_ptr = pool;
     p_rb->buffer_size = size;
+#if LM_RINGBUF_STAT_ENABLED
+    memset(&p_rb->stat, 0, sizeof(p_rb->stat));
+#endif
+    lm_atomic_store_relaxed(&p_rb->read_index, 0);
+    lm_atomic_store_relaxed(&p_rb->overrun_seq, 0);
+    lm_atomic_store_relaxed(&p_rb->overrun_ack, 0);
+    lm_atomic_store_release(&p_rb->write_index, 0);
 
     return LM_OK;
 }
@@ -51,43 +263,39 @@ size_t lm_ringbuf_put (struct lm_ringbuf *p_rb,
                        const uint8_t     *ptr,
                        uint16_t           length)
 {
-    uint16_t size;
+    uint32_t read_index, write_index;
+    uint32_t size;
 
     if (p_rb == NULL) {
         return -LM_EINVAL;
     }
 
+    /* 读索引由消费者发布, 写索引只有生产者自己修改 */
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+
     /* whether has enough space */
-    size = lm_ringbuf_space_len(p_rb);
+    size = p_rb->buffer_size - __ringbuf_distance(p_rb, read_index, write_index);
 
     /* no space */
-    if (size == 0)
+    if (size == 0) {
+        __ringbuf_stat_in(p_rb, 0, length, p_rb->buffer_size);
         return 0;
+    }
 
     /* drop some data */
-    if (size < length)
+    if (size < length) {
+        __ringbuf_stat_in(p_rb, 0, length - size, 0);
         length = size;
-
-    if (p_rb->buffer_size - p_rb->write_index > length)
-    {
-        /* read_index - write_index = empty space */
-        memcpy(&p_rb->buffer_ptr[p_rb->write_index], ptr, length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        p_rb->write_index += length;
-        return length;
     }
 
-    memcpy(&p_rb->buffer_ptr[p_rb->write_index],
-           &ptr[0],
-           p_rb->buffer_size - p_rb->write_index);
-    memcpy(&p_rb->buffer_ptr[0],
-           &ptr[p_rb->buffer_size - p_rb->write_index],
-           length - (p_rb->buffer_size - p_rb->write_index));
+    __ringbuf_copy_in(p_rb, write_index, ptr, length);
+
+    /* 数据写完后再发布写索引 */
+    lm_atomic_store_release(&p_rb->write_index,
+                            __ringbuf_advance(p_rb, write_index, length));
 
-    /* we are going into the other side of the mirror */
-    p_rb->write_mirror = ~p_rb->write_mirror;
-    p_rb->write_index = length - (p_rb->buffer_size - p_rb->write_index);
+    __ringbuf_stat_in(p_rb, length, 0, p_rb->buffer_size - size + length);
 
     return length;
 }
@@ -99,49 +307,48 @@ size_t lm_ringbuf_put_force (struct lm_ringbuf *p_rb,
                              const uint8_t     *ptr,
                              uint16_t           length)
 {
-    uint16_t space_length;
+    uint32_t read_index, write_index;
+    uint32_t space_length;
 
     if (p_rb == NULL) {
         return -LM_EINVAL;
     }
 
-    space_length = lm_ringbuf_space_len(p_rb);
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+
+    space_length = p_rb->buffer_size -
+                   __ringbuf_distance(p_rb, read_index, write_index);
 
     if (length > p_rb->buffer_size)
     {
+        /* 超出容量的前段输入从未进入缓冲区, 不算作覆盖 */
+        __ringbuf_stat_truncate(p_rb, length - p_rb->buffer_size);
         ptr = &ptr[length - p_rb->buffer_size];
         length = p_rb->buffer_size;
     }
 
-    if (p_rb->buffer_size - p_rb->write_index > length)
+    /*
+     * 旧数据被覆盖(只统计原来在缓冲区中的数据). 读索引只由消费者修改,
+     * 这里通过覆盖序号通知消费者丢掉最早的数据重新同步
+     */
+    if (length > space_length)
     {
-        /* read_index - write_index = empty space */
-        memcpy(&p_rb->buffer_ptr[p_rb->write_index], ptr, length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        p_rb->write_index += length;
-
-        if (length > space_length)
-            p_rb->read_index = p_rb->write_index;
+        __ringbuf_overrun_begin(p_rb);
+        __ringbuf_copy_in(p_rb, write_index, ptr, length);
+        __ringbuf_overrun_end(p_rb, __ringbuf_advance(p_rb, write_index, length));
 
-        return length;
+        __ringbuf_stat_overwrite(p_rb, length - space_length);
+        __ringbuf_stat_in(p_rb, length, 0, p_rb->buffer_size);
     }
-
-    memcpy(&p_rb->buffer_ptr[p_rb->write_index],
-           &ptr[0],
-           p_rb->buffer_size - p_rb->write_index);
-    memcpy(&p_rb->buffer_ptr[0],
-           &ptr[p_rb->buffer_size - p_rb->write_index],
-           length - (p_rb->buffer_size - p_rb->write_index));
-
-    /* we are going into the other side of the mirror */
-    p_rb->write_mirror = ~p_rb->write_mirror;
-    p_rb->write_index = length - (p_rb->buffer_size - p_rb->write_index);
-
-    if (length > space_length)
+    else
     {
-        p_rb->read_mirror = ~p_rb->read_mirror;
-        p_rb->read_index = p_rb->write_index;
+        __ringbuf_copy_in(p_rb, write_index, ptr, length);
+        lm_atomic_store_release(&p_rb->write_index,
+                                __ringbuf_advance(p_rb, write_index, length));
+
+        __ringbuf_stat_in(p_rb, length, 0,
+                          p_rb->buffer_size - space_length + length);
     }
 
     return length;
@@ -154,43 +361,40 @@ size_t lm_ringbuf_get (struct lm_ringbuf *p_rb,
                        uint8_t           *ptr,
                        uint16_t           length)
 {
+    uint32_t read_index, write_index, seq;
+    uint16_t want = length;
     size_t size;
 
     if (p_rb == NULL) {
         return -LM_EINVAL;
     }
 
-    /* whether has enough data  */
-    size = lm_ringbuf_data_len(p_rb);
+    /* 写索引由生产者发布, 读索引只有消费者自己修改 */
+    do {
+        seq = __ringbuf_consumer_begin(p_rb, &read_index, &write_index);
+        if (seq & 1)
+            return 0;
 
-    /* no data */
-    if (size == 0)
-        return 0;
+        /* whether has enough data  */
+        size = __ringbuf_distance(p_rb, read_index, write_index);
 
-    /* less data */
-    if (size < length)
-        length = size;
+        /* no data */
+        if (size == 0)
+            return 0;
 
-    if (p_rb->buffer_size - p_rb->read_index > length)
-    {
-        /* copy all of data */
-        memcpy(ptr, &p_rb->buffer_ptr[p_rb->read_index], length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        p_rb->read_index += length;
-        return length;
-    }
+        /* less data */
+        length = (size < want) ? size : want;
+
+        __ringbuf_copy_out(p_rb, read_index, ptr, length);
 
-    memcpy(&ptr[0],
-           &p_rb->buffer_ptr[p_rb->read_index],
-           p_rb->buffer_size - p_rb->read_index);
-    memcpy(&ptr[p_rb->buffer_size - p_rb->read_index],
-           &p_rb->buffer_ptr[0],
-           length - (p_rb->buffer_size - p_rb->read_index));
+        /* 拷贝期间被覆盖则丢弃本次结果重新读 */
+    } while (!__ringbuf_consumer_valid(p_rb, seq));
 
-    /* we are going into the other side of the mirror */
-    p_rb->read_mirror = ~p_rb->read_mirror;
-    p_rb->read_index = length - (p_rb->buffer_size - p_rb->read_index);
+    /* 数据读完后再发布读索引, 之后生产者才可以覆盖这段空间 */
+    lm_atomic_store_release(&p_rb->read_index,
+                            __ringbuf_advance(p_rb, read_index, length));
+
+    __ringbuf_stat_out(p_rb, length);
 
     return length;
 }
@@ -200,26 +404,29 @@ size_t lm_ringbuf_get (struct lm_ringbuf *p_rb,
  */
 size_t lm_ringbuf_putchar (struct lm_ringbuf *p_rb, const uint8_t ch)
 {
+    uint32_t read_index, write_index;
+    uint32_t used;
+
     if (p_rb == NULL) {
         return -LM_EINVAL;
     }
 
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+    used        = __ringbuf_distance(p_rb, read_index, write_index);
+
     /* whether has enough space */
-    if (!lm_ringbuf_space_len(p_rb))
+    if (used == (uint32_t)p_rb->buffer_size) {
+        __ringbuf_stat_in(p_rb, 0, 1, used);
         return 0;
+    }
 
-    p_rb->buffer_ptr[p_rb->write_index] = ch;
+    p_rb->buffer_ptr[__ringbuf_offset(p_rb, write_index)] = ch;
 
-    /* flip mirror */
-    if (p_rb->write_index == p_rb->buffer_size-1)
-    {
-        p_rb->write_mirror = ~p_rb->write_mirror;
-        p_rb->write_index = 0;
-    }
-    else
-    {
-        p_rb->write_index++;
-    }
+    lm_atomic_store_release(&p_rb->write_index,
+                            __ringbuf_advance(p_rb, write_index, 1));
+
+    __ringbuf_stat_in(p_rb, 1, 0, used + 1);
 
     return 1;
 }
@@ -231,32 +438,36 @@ size_t lm_ringbuf_putchar (struct lm_ringbuf *p_rb, const uint8_t ch)
  */
 size_t lm_ringbuf_putchar_force(struct lm_ringbuf *p_rb, const uint8_t ch)
 {
-    enum lm_ringbuf_state old_state;
+    uint32_t read_index, write_index;
+    bool     full;
 
     if (p_rb == NULL) {
         return -LM_EINVAL;
     }
 
-    old_state = lm_ringbuf_status(p_rb);
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
 
-    p_rb->buffer_ptr[p_rb->write_index] = ch;
+    full = (__ringbuf_distance(p_rb, read_index, write_index) ==
+            (uint32_t)p_rb->buffer_size);
 
-    /* flip mirror */
-    if (p_rb->write_index == p_rb->buffer_size-1)
+    if (full)
     {
-        p_rb->write_mirror = ~p_rb->write_mirror;
-        p_rb->write_index = 0;
-        if (old_state == LM_RINGBUF_FULL)
-        {
-            p_rb->read_mirror = ~p_rb->read_mirror;
-            p_rb->read_index = p_rb->write_index;
-        }
+        __ringbuf_overrun_begin(p_rb);
+        p_rb->buffer_ptr[__ringbuf_offset(p_rb, write_index)] = ch;
+        __ringbuf_overrun_end(p_rb, __ringbuf_advance(p_rb, write_index, 1));
+
+        __ringbuf_stat_overwrite(p_rb, 1);
+        __ringbuf_stat_in(p_rb, 1, 0, p_rb->buffer_size);
     }
     else
     {
-        p_rb->write_index++;
-        if (old_state == LM_RINGBUF_FULL)
-            p_rb->read_index = p_rb->write_index;
+        p_rb->buffer_ptr[__ringbuf_offset(p_rb, write_index)] = ch;
+        write_index = __ringbuf_advance(p_rb, write_index, 1);
+        lm_atomic_store_release(&p_rb->write_index, write_index);
+
+        __ringbuf_stat_in(p_rb, 1, 0,
+                          __ringbuf_distance(p_rb, read_index, write_index));
     }
 
     return 1;
@@ -267,29 +478,386 @@ size_t lm_ringbuf_putchar_force(struct lm_ringbuf *p_rb, const uint8_t ch)
  */
 size_t lm_ringbuf_getchar(struct lm_ringbuf *p_rb, uint8_t *ch)
 {
+    uint32_t read_index, write_index, seq;
+
     if (p_rb == NULL) {
         return -LM_EINVAL;
     }
 
+    do {
+        seq = __ringbuf_consumer_begin(p_rb, &read_index, &write_index);
+
+        /* ringbuffer is empty */
+        if ((seq & 1) || read_index == write_index)
+            return 0;
+
+        /* put character */
+        *ch = p_rb->buffer_ptr[__ringbuf_offset(p_rb, read_index)];
+    } while (!__ringbuf_consumer_valid(p_rb, seq));
+
+    lm_atomic_store_release(&p_rb->read_index,
+                            __ringbuf_advance(p_rb, read_index, 1));
+
+    __ringbuf_stat_out(p_rb, 1);
+
+    return 1;
+}
+
+/**
+ * @brief 将索引index开始的length个字节描述为两段连续空间
+ */
+static void __ringbuf_span (struct lm_ringbuf      *p_rb,
+                            uint32_t                index,
+                            uint32_t                length,
+                            struct lm_ringbuf_span  span[2])
+{
+    uint32_t offset = __ringbuf_offset(p_rb, index);
+    uint32_t tail   = p_rb->buffer_size - offset;
+
+    span[0].ptr = &p_rb->buffer_ptr[offset];
+    span[1].ptr = &p_rb->buffer_ptr[0];
+
+    if (tail >= length) {
+        span[0].len = length;
+        span[1].len = 0;
+    } else {
+        span[0].len = tail;
+        span[1].len = length - tail;
+    }
+}
+
+/**
+ * @brief 预留可写空间
+ */
+size_t lm_ringbuf_reserve (struct lm_ringbuf      *p_rb,
+                           size_t                  length,
+                           struct lm_ringbuf_span  span[2])
+{
+    uint32_t read_index, write_index;
+    uint32_t size;
 
-    /* ringbuffer is empty */
-    if (!lm_ringbuf_data_len(p_rb))
+    if (p_rb == NULL || span == NULL) {
         return 0;
+    }
 
-    /* put character */
-    *ch = p_rb->buffer_ptr[p_rb->read_index];
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
 
-    if (p_rb->read_index == p_rb->buffer_size-1)
+    size = p_rb->buffer_size - __ringbuf_distance(p_rb, read_index, write_index);
+    if (size < length)
+        length = size;
+
+    __ringbuf_span(p_rb, write_index, length, span);
+
+    return length;
+}
+
+/**
+ * @brief 提交已写入预留空间的数据
+ */
+size_t lm_ringbuf_commit (struct lm_ringbuf *p_rb, size_t length)
+{
+    uint32_t read_index, write_index;
+    uint32_t size;
+
+    if (p_rb == NULL) {
+        return 0;
+    }
+
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+
+    /* 不能提交超过空闲空间的数据 */
+    size = p_rb->buffer_size - __ringbuf_distance(p_rb, read_index, write_index);
+    if (size < length)
+        length = size;
+
+    lm_atomic_store_release(&p_rb->write_index,
+                            __ringbuf_advance(p_rb, write_index, length));
+
+    __ringbuf_stat_in(p_rb, length, 0, p_rb->buffer_size - size + length);
+
+    return length;
+}
+
+/**
+ * @brief 查看可读数据
+ */
+size_t lm_ringbuf_peek_contig (struct lm_ringbuf      *p_rb,
+                               struct lm_ringbuf_span  span[2])
+{
+    uint32_t read_index, write_index;
+    uint32_t size;
+
+    if (p_rb == NULL || span == NULL) {
+        return 0;
+    }
+
+    /* 生产者正在覆盖时读写索引相同, 按没有数据返回 */
+    __ringbuf_consumer_begin(p_rb, &read_index, &write_index);
+
+    size = __ringbuf_distance(p_rb, read_index, write_index);
+
+    __ringbuf_span(p_rb, read_index, size, span);
+
+    return size;
+}
+
+/**
+ * @brief 释放已处理的数据
+ */
+size_t lm_ringbuf_consume (struct lm_ringbuf *p_rb, size_t length)
+{
+    uint32_t read_index, write_index;
+    uint32_t size, seq;
+
+    if (p_rb == NULL) {
+        return 0;
+    }
+
+    /* 查看之后数据被生产者覆盖过, 读索引已经重新同步, 不能再释放 */
+    seq = lm_atomic_load_relaxed(&p_rb->overrun_ack);
+    if (__ringbuf_consumer_begin(p_rb, &read_index, &write_index) != seq)
+        return 0;
+
+    /* 不能释放超过已有数据的长度 */
+    size = __ringbuf_distance(p_rb, read_index, write_index);
+    if (size < length)
+        length = size;
+
+    lm_atomic_store_release(&p_rb->read_index,
+                            __ringbuf_advance(p_rb, read_index, length));
+
+    __ringbuf_stat_out(p_rb, length);
+
+    return length;
+}
+
+/**
+ * @brief 根据DMA硬件写位置发布数据
+ */
+size_t lm_ringbuf_dma_update (struct lm_ringbuf *p_rb, uint32_t offset)
+{
+    uint32_t read_index, write_index;
+    uint32_t current, length, space;
+
+    if (p_rb == NULL || offset >= (uint32_t)p_rb->buffer_size) {
+        return 0;
+    }
+
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+
+    /* 上次发布的位置到DMA当前位置之间是新数据 */
+    current = __ringbuf_offset(p_rb, write_index);
+    if (offset >= current)
+        length = offset - current;
+    else
+        length = p_rb->buffer_size - current + offset;
+
+    if (length == 0)
+        return 0;
+
+    space = p_rb->buffer_size - __ringbuf_distance(p_rb, read_index, write_index);
+
+    /* 保证DMA写入的数据在索引发布之前对CPU可见 */
+    dma_rmb();
+
+    write_index = __ringbuf_advance(p_rb, write_index, length);
+
+    /*
+     * DMA已经覆盖了未读的数据, 只能丢掉最早的数据. 读索引只由消费者修改,
+     * 这里只递增覆盖序号, 消费者下次读取时重新同步, 正在拷贝的数据也会被作废
+     */
+    if (length > space)
     {
-        p_rb->read_mirror = ~p_rb->read_mirror;
-        p_rb->read_index = 0;
+        __ringbuf_overrun_begin(p_rb);
+        __ringbuf_overrun_end(p_rb, write_index);
+
+        __ringbuf_stat_overwrite(p_rb, length - space);
+        __ringbuf_stat_in(p_rb, length, 0, p_rb->buffer_size);
     }
     else
     {
-        p_rb->read_index++;
+        lm_atomic_store_release(&p_rb->write_index, write_index);
+
+        __ringbuf_stat_in(p_rb, length, 0,
+                          p_rb->buffer_size - space + length);
     }
 
-    return 1;
+    return length;
+}
+
+/**
+ * @brief 编码记录长度头, 返回长度头的字节数
+ */
+static inline uint32_t __ringbuf_record_hdr_encode (uint8_t hdr[2], uint16_t length)
+{
+    if (length < 0x80) {
+        hdr[0] = length;
+        return 1;
+    }
+
+    hdr[0] = 0x80 | (length >> 8);
+    hdr[1] = length & 0xFF;
+    return 2;
+}
+
+/**
+ * @brief 解析索引index处的记录长度头, 返回长度头的字节数(数据不足时返回0)
+ */
+static uint32_t __ringbuf_record_hdr_decode (struct lm_ringbuf *p_rb,
+                                             uint32_t           index,
+                                             uint32_t           size,
+                                             uint16_t          *p_length)
+{
+    uint8_t hdr[2];
+
+    if (size < 1)
+        return 0;
+
+    __ringbuf_copy_out(p_rb, index, hdr, 1);
+    if (!(hdr[0] & 0x80)) {
+        *p_length = hdr[0];
+        return 1;
+    }
+
+    if (size < 2)
+        return 0;
+
+    __ringbuf_copy_out(p_rb, __ringbuf_advance(p_rb, index, 1), &hdr[1], 1);
+    *p_length = ((hdr[0] & 0x7F) << 8) | hdr[1];
+    return 2;
+}
+
+/**
+ * @brief 写入一条记录
+ */
+size_t lm_ringbuf_put_record (struct lm_ringbuf *p_rb,
+                              const uint8_t     *ptr,
+                              uint16_t           length)
+{
+    uint32_t read_index, write_index;
+    uint32_t size, hdr_len;
+    uint8_t  hdr[2];
+
+    if (p_rb == NULL || ptr == NULL || length == 0 ||
+        length > LM_RINGBUF_RECORD_MAX) {
+        return -LM_EINVAL;
+    }
+
+    write_index = lm_atomic_load_relaxed(&p_rb->write_index);
+    read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+
+    size    = p_rb->buffer_size - __ringbuf_distance(p_rb, read_index, write_index);
+    hdr_len = __ringbuf_record_hdr_encode(hdr, length);
+
+    /* 放不下整条记录则丢弃 */
+    if (size < hdr_len + length) {
+        __ringbuf_stat_in(p_rb, 0, hdr_len + length, 0);
+        return 0;
+    }
+
+    __ringbuf_copy_in(p_rb, write_index, hdr, hdr_len);
+    __ringbuf_copy_in(p_rb, __ringbuf_advance(p_rb, write_index, hdr_len),
+                      ptr, length);
+
+    /* 长度头和数据一次发布, 消费者看不到半条记录 */
+    lm_atomic_store_release(&p_rb->write_index,
+                            __ringbuf_advance(p_rb, write_index,
+                                              hdr_len + length));
+
+    __ringbuf_stat_in(p_rb, hdr_len + length, 0,
+                      p_rb->buffer_size - size + hdr_len + length);
+
+    return length;
+}
+
+/**
+ * @brief 读出一条记录
+ */
+size_t lm_ringbuf_get_record (struct lm_ringbuf *p_rb,
+                              uint8_t           *ptr,
+                              uint16_t           length)
+{
+    uint32_t read_index, write_index;
+    uint32_t size, hdr_len, seq;
+    uint16_t record_len, want = length;
+
+    /*
+     * 空记录在写入时就被拒绝, 读出长度也至少为1, 返回0只表示没有记录,
+     * 不会和"读出了一条0字节的记录"混淆
+     */
+    if (p_rb == NULL || ptr == NULL || length == 0) {
+        return -LM_EINVAL;
+    }
+
+    do {
+        seq = __ringbuf_consumer_begin(p_rb, &read_index, &write_index);
+        if (seq & 1)
+            return 0;
+
+        size    = __ringbuf_distance(p_rb, read_index, write_index);
+        hdr_len = __ringbuf_record_hdr_decode(p_rb, read_index, size, &record_len);
+
+        /* 没有记录(数据按记录整条发布, 不会出现半条) */
+        if (hdr_len == 0)
+            return 0;
+
+        /*
+         * 长度头损坏(例如与按字节读写的接口混用), 不能当作空记录跳过.
+         * 之后的记录边界都无法确定, 丢弃已写入的全部数据后重新同步,
+         * 否则以后每次读取都会停在这里
+         */
+        if (record_len == 0 || hdr_len + record_len > size) {
+            if (__ringbuf_consumer_valid(p_rb, seq)) {
+                lm_atomic_store_release(&p_rb->read_index, write_index);
+                return -LM_EIO;
+            }
+            continue;
+        }
+
+        length = (want > record_len) ? record_len : want;
+
+        __ringbuf_copy_out(p_rb, __ringbuf_advance(p_rb, read_index, hdr_len),
+                           ptr, length);
+    } while (!__ringbuf_consumer_valid(p_rb, seq));
+
+    /* 整条记录一次释放, 截断的部分一并丢弃 */
+    lm_atomic_store_release(&p_rb->read_index,
+                            __ringbuf_advance(p_rb, read_index,
+                                              hdr_len + record_len));
+
+    __ringbuf_stat_out(p_rb, hdr_len + record_len);
+
+    return length;
+}
+
+/**
+ * @brief 获取下一条记录的长度
+ */
+size_t lm_ringbuf_peek_record_len (struct lm_ringbuf *p_rb)
+{
+    uint32_t read_index, write_index, seq;
+    uint16_t record_len;
+
+    if (p_rb == NULL) {
+        return 0;
+    }
+
+    do {
+        seq = __ringbuf_consumer_begin(p_rb, &read_index, &write_index);
+        if (seq & 1)
+            return 0;
+
+        if (!__ringbuf_record_hdr_decode(p_rb, read_index,
+                                         __ringbuf_distance(p_rb, read_index,
+                                                            write_index),
+                                         &record_len))
+            return 0;
+    } while (!__ringbuf_consumer_valid(p_rb, seq));
+
+    return record_len;
 }
 
 /** 
@@ -297,19 +865,15 @@ size_t lm_ringbuf_getchar(struct lm_ringbuf *p_rb, uint8_t *ch)
  */
 size_t lm_ringbuf_data_len (struct lm_ringbuf *p_rb)
 {
-    switch (lm_ringbuf_status(p_rb))
-    {
-    case LM_RINGBUF_EMPTY:
-        return 0;
-    case LM_RINGBUF_FULL:
-        return p_rb->buffer_size;
-    case LM_RINGBUF_HALFFULL:
-    default:
-        if (p_rb->write_index > p_rb->read_index)
-            return p_rb->write_index - p_rb->read_index;
-        else
-            return p_rb->buffer_size - (p_rb->read_index - p_rb->write_index);
-    };
+    uint32_t write_index = lm_atomic_load_acquire(&p_rb->write_index);
+    uint32_t read_index  = __ringbuf_producer_read_index(p_rb, write_index);
+    uint32_t length      = __ringbuf_distance(p_rb, read_index, write_index);
+
+    /* 两个索引不是同时读到的, 在第三方上下文中查询时可能略大于容量 */
+    if (length > (uint32_t)p_rb->buffer_size)
+        length = p_rb->buffer_size;
+
+    return length;
 }
 
 /** 
@@ -321,10 +885,43 @@ void lm_ringbuf_reset (struct lm_ringbuf *p_rb)
         return;
     }
 
-    p_rb->read_mirror = 0;
-    p_rb->read_index = 0;
-    p_rb->write_mirror = 0;
-    p_rb->write_index = 0;
+    lm_atomic_store_relaxed(&p_rb->read_index, 0);
+    lm_atomic_store_relaxed(&p_rb->overrun_seq, 0);
+    lm_atomic_store_relaxed(&p_rb->overrun_ack, 0);
+    lm_atomic_store_release(&p_rb->write_index, 0);
+}
+
+/**
+ * @brief 获取环形缓存区统计
+ */
+int lm_ringbuf_get_stat (struct lm_ringbuf *p_rb, struct lm_ringbuf_stat *p_stat)
+{
+    if (p_rb == NULL || p_stat == NULL) {
+        return -LM_EINVAL;
+    }
+
+#if LM_RINGBUF_STAT_ENABLED
+    memcpy(p_stat, &p_rb->stat, sizeof(*p_stat));
+
+    return LM_OK;
+#else
+    return -LM_ENOTSUP;
+#endif
+}
+
+/**
+ * @brief 清除环形缓存区统计
+ */
+void lm_ringbuf_clear_stat (struct lm_ringbuf *p_rb)
+{
+    if (p_rb == NULL) {
+        return;
+    }
+
+#if LM_RINGBUF_STAT_ENABLED
+    memset(&p_rb->stat, 0, sizeof(p_rb->stat));
+    p_rb->stat.high_water = lm_ringbuf_data_len(p_rb);
+#endif
 }
 
 /* end of file */
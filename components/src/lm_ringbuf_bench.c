@@ -0,0 +1,220 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_ringbuf_bench.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 环形缓冲区性能测试模块
+*******************************************************************************/
+
+#include "lm_ringbuf.h"
+#include "lmiracle.h"
+#include "lm_kservice.h"
+
+#if LM_RINGBUF_BENCH_ENABLED
+
+/* 每个测试项至少运行的时间(ms) */
+#ifndef LM_RINGBUF_BENCH_MS
+#define LM_RINGBUF_BENCH_MS         100
+#endif
+
+/* 每批执行的操作次数, 批与批之间读取一次tick */
+#define __BENCH_BATCH               64
+
+/* 测试的缓冲区大小和块大小 */
+static const uint16_t __g_bench_buf_size[] = {64, 512, 4096};
+static const uint16_t __g_bench_chunk[]    = {8, 64, 256};
+
+enum __bench_op {
+    __BENCH_BASE,                   /* commit + consume, 作为块操作的基准扣除 */
+    __BENCH_PUT,                    /* put + consume */
+    __BENCH_GET,                    /* commit + get */
+    __BENCH_PUTCHAR,                /* putchar + consume */
+    __BENCH_GETCHAR,                /* commit + getchar */
+    __BENCH_PUT_FORCE,              /* 缓冲区始终满, put_force */
+};
+
+static const char *__g_bench_name[] = {
+    "base", "put", "get", "putchar", "getchar", "put_force",
+};
+
+/* 测试结果 */
+struct __bench_result {
+    uint32_t ops;
+    uint32_t ms;
+};
+
+/**
+ * @brief 执行一次操作
+ */
+static inline void __bench_op_once (struct lm_ringbuf *p_rb,
+                                    enum __bench_op    op,
+                                    uint8_t           *p_data,
+                                    uint16_t           chunk)
+{
+    switch (op) {
+    case __BENCH_BASE:
+        lm_ringbuf_commit(p_rb, chunk);
+        lm_ringbuf_consume(p_rb, chunk);
+        break;
+    case __BENCH_PUT:
+        lm_ringbuf_put(p_rb, p_data, chunk);
+        lm_ringbuf_consume(p_rb, chunk);
+        break;
+    case __BENCH_GET:
+        lm_ringbuf_commit(p_rb, chunk);
+        lm_ringbuf_get(p_rb, p_data, chunk);
+        break;
+    case __BENCH_PUTCHAR:
+        lm_ringbuf_putchar(p_rb, p_data[0]);
+        lm_ringbuf_consume(p_rb, 1);
+        break;
+    case __BENCH_GETCHAR:
+        lm_ringbuf_commit(p_rb, 1);
+        lm_ringbuf_getchar(p_rb, p_data);
+        break;
+    case __BENCH_PUT_FORCE:
+        lm_ringbuf_put_force(p_rb, p_data, chunk);
+        break;
+    }
+}
+
+/**
+ * @brief 运行一个测试项
+ */
+static void __bench_run (struct lm_ringbuf     *p_rb,
+                         enum __bench_op        op,
+                         uint8_t               *p_data,
+                         uint16_t               chunk,
+                         uint16_t               offset,
+                         struct __bench_result *p_result)
+{
+    lm_tick_t start;
+    uint32_t  i;
+
+    /* 把读写位置移动到offset处, 控制块跨越缓冲区末尾的位置 */
+    lm_ringbuf_reset(p_rb);
+    lm_ringbuf_commit(p_rb, offset);
+    lm_ringbuf_consume(p_rb, offset);
+
+    if (op == __BENCH_PUT_FORCE) {
+        lm_ringbuf_commit(p_rb, lm_ringbuf_get_size(p_rb));
+    }
+
+    p_result->ops = 0;
+    start = lm_sys_get_tick();
+
+    do {
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            __bench_op_once(p_rb, op, p_data, chunk);
+        }
+        p_result->ops += __BENCH_BATCH;
+        p_result->ms   = lm_tick_to_ms(lm_sys_get_tick() - start);
+    } while (p_result->ms < LM_RINGBUF_BENCH_MS);
+}
+
+/**
+ * @brief 输出一个测试结果(CSV), 块操作扣除基准时间
+ */
+static void __bench_report (enum __bench_op        op,
+                            uint16_t               size,
+                            uint16_t               chunk,
+                            uint16_t               offset,
+                            struct __bench_result *p_result,
+                            struct __bench_result *p_base)
+{
+    uint64_t raw_ps, ps, base_ps, bytes;
+    bool     byte_op = (op == __BENCH_PUTCHAR || op == __BENCH_GETCHAR);
+
+    /* 以ps为单位计算, 避免快速操作的ns值被截断 */
+    raw_ps = (uint64_t)p_result->ms * 1000000000u / p_result->ops;
+    ps     = raw_ps;
+
+    /*
+     * 块操作的基准只包含索引操作, 扣除后为拷贝本身的开销. 单字节操作
+     * 本身和基准的开销相当, 扣除后只剩噪声, 因此不扣除
+     */
+    if (!byte_op && (op != __BENCH_PUT_FORCE)) {
+        base_ps = (uint64_t)p_base->ms * 1000000000u / p_base->ops;
+        ps      = (ps > base_ps) ? ps - base_ps : 0;
+    }
+
+    bytes = byte_op ? 1 : chunk;
+
+    lm_kprintf("%s,%u,%u,%u,%u,%u,%u,%u.%02u,%u.%02u\r\n",
+               __g_bench_name[op],
+               size,
+               (unsigned)bytes,
+               offset,
+               p_result->ops,
+               p_result->ms,
+               (unsigned)(ps ? bytes * 1000000000u / ps : 0),
+               (unsigned)(ps / 1000), (unsigned)(ps % 1000 / 10),
+               (unsigned)(raw_ps / 1000), (unsigned)(raw_ps % 1000 / 10));
+}
+
+/**
+ * @brief 环形缓冲区性能测试
+ */
+int lm_ringbuf_bench (uint8_t *pool, size_t pool_size)
+{
+    static uint8_t        data[256];
+    struct lm_ringbuf     rb;
+    struct __bench_result base, result;
+    uint16_t              size, chunk, offset;
+    uint32_t              s, c, w;
+    int                   op;
+
+    if (pool == NULL) {
+        return -LM_EINVAL;
+    }
+
+    /* 测试数据放在静态区, 不占用调用者(shell任务)的栈 */
+    memset(data, 0x5A, sizeof(data));
+
+    lm_kprintf("op,buf,chunk,offset,ops,ms,kbytes_per_s,ns_per_op,raw_ns_per_op\r\n");
+
+    for (s = 0; s < ARRAY_LEN(__g_bench_buf_size); s++) {
+        size = __g_bench_buf_size[s];
+        if (size > pool_size) {
+            break;
+        }
+        lm_ringbuf_init(&rb, pool, size);
+
+        for (c = 0; c < ARRAY_LEN(__g_bench_chunk); c++) {
+            chunk = __g_bench_chunk[c];
+            if (chunk > size) {
+                break;
+            }
+
+            /* 起始位置0: 块不跨越末尾; 起始位置chunk/2: 每圈有一个块跨越末尾 */
+            for (w = 0; w < 2; w++) {
+                offset = w ? chunk / 2 : 0;
+
+                __bench_run(&rb, __BENCH_BASE, data, chunk, offset, &base);
+
+                for (op = __BENCH_PUT; op <= __BENCH_PUT_FORCE; op++) {
+                    /* 单字节操作与块大小无关, 只在第一个块大小下测试 */
+                    if ((op == __BENCH_PUTCHAR || op == __BENCH_GETCHAR) && c) {
+                        continue;
+                    }
+
+                    __bench_run(&rb, op, data, chunk, offset, &result);
+                    __bench_report(op, size, chunk, offset, &result, &base);
+                }
+            }
+        }
+    }
+
+    return LM_OK;
+}
+
+#endif /* LM_RINGBUF_BENCH_ENABLED */
+
+/* end of file */
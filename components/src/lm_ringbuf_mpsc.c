@@ -0,0 +1,311 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_ringbuf_mpsc.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 多生产者/单消费者记录环形缓冲区模块
+*******************************************************************************/
+
+#include "lm_ringbuf_mpsc.h"
+#include "lmiracle.h"
+#include "lm_atomic.h"
+#include <string.h>
+
+/*
+ * 记录头(32位):
+ *   bit31      已提交
+ *   bit30      填充记录(消费者直接跳过)
+ *   bit29~0    记录长度
+ *
+ * 消费者释放记录时会把整条记录清零, 因此已申请但生产者还没写记录头的
+ * 位置读到的一定是0(未提交), 不会把上一圈留下的旧数据误认为记录头.
+ */
+#define __MPSC_HDR_SIZE         4
+#define __MPSC_FLAG_COMMIT      0x80000000UL
+#define __MPSC_FLAG_PAD         0x40000000UL
+#define __MPSC_LEN_MASK         0x3FFFFFFFUL
+
+/* 按4字节对齐 */
+#define __MPSC_ALIGN(n)         (((n) + 3) & ~3UL)
+
+/**
+ * @brief 计数pos处的记录头
+ */
+static inline uint32_t *__mpsc_hdr (struct lm_ringbuf_mpsc *p_rb, uint32_t pos)
+{
+    return (uint32_t *)&p_rb->buffer[pos & p_rb->mask];
+}
+
+/**
+ * @brief 从计数head处申请total字节需要占用的空间(包括末尾的填充)
+ */
+static inline uint32_t __mpsc_need (struct lm_ringbuf_mpsc *p_rb,
+                                    uint32_t                head,
+                                    uint32_t                total)
+{
+    uint32_t contig = p_rb->mask + 1 - (head & p_rb->mask);
+
+    return (contig >= total) ? total : contig + total;
+}
+
+/**
+ * @brief 申请空间, 成功时返回真, 并通过p_head返回申请到的起始计数
+ */
+static bool __mpsc_reserve (struct lm_ringbuf_mpsc *p_rb,
+                            uint32_t                total,
+                            uint32_t               *p_head,
+                            uint32_t               *p_need)
+{
+    uint32_t head, tail, need;
+
+#ifdef LM_ATOMIC_HAS_CAS
+    head = lm_atomic_load_relaxed(&p_rb->head);
+    do {
+        tail = lm_atomic_load_acquire(&p_rb->tail);
+        need = __mpsc_need(p_rb, head, total);
+
+        if (p_rb->mask + 1 - (head - tail) < need) {
+            return false;
+        }
+    } while (!lm_atomic_cas(&p_rb->head, &head, head + need));
+#else
+    lm_base_t state = lm_critical_enter_isr();
+
+    head = p_rb->head;
+    tail = lm_atomic_load_acquire(&p_rb->tail);
+    need = __mpsc_need(p_rb, head, total);
+
+    if (p_rb->mask + 1 - (head - tail) < need) {
+        lm_critical_exit_isr(state);
+        return false;
+    }
+    p_rb->head = head + need;
+
+    lm_critical_exit_isr(state);
+#endif
+
+    *p_head = head;
+    *p_need = need;
+
+    return true;
+}
+
+/**
+ * @brief 初始化多生产者环形缓冲区
+ */
+int lm_ringbuf_mpsc_init (struct lm_ringbuf_mpsc *p_rb,
+                          uint8_t                *pool,
+                          size_t                  size)
+{
+    /* 1.参数检查 */
+    if (unlikely(NULL == p_rb || NULL == pool || size < 16)) {
+        return -LM_EINVAL;
+    }
+
+    if ((size & (size - 1)) || (size > 0x80000000UL) ||
+        ((uintptr_t)pool & (__MPSC_HDR_SIZE - 1))) {
+        return -LM_EINVAL;
+    }
+
+    /* 2.清零, 保证未写入的记录头都是未提交状态 */
+    memset(pool, 0, size);
+
+    p_rb->buffer = pool;
+    p_rb->mask   = size - 1;
+    lm_atomic_store_relaxed(&p_rb->tail, 0);
+    lm_atomic_store_release(&p_rb->head, 0);
+
+    return LM_OK;
+}
+
+/**
+ * @brief 申请一条记录的空间
+ */
+void *lm_ringbuf_mpsc_claim (struct lm_ringbuf_mpsc *p_rb, size_t length)
+{
+    uint32_t head, need, total;
+
+    if (p_rb == NULL || length == 0) {
+        return NULL;
+    }
+
+    /* 不超过缓冲区的一半, 保证带填充时也一定放得下 */
+    if (length > (p_rb->mask + 1) / 2 - __MPSC_HDR_SIZE) {
+        return NULL;
+    }
+
+    total = __MPSC_HDR_SIZE + __MPSC_ALIGN(length);
+
+    if (!__mpsc_reserve(p_rb, total, &head, &need)) {
+        return NULL;
+    }
+
+    /* 末尾放不下, 先写一条填充记录, 记录本身从缓冲区开头开始 */
+    if (need != total) {
+        lm_atomic_store_release(__mpsc_hdr(p_rb, head),
+                                __MPSC_FLAG_COMMIT | __MPSC_FLAG_PAD |
+                                (need - total - __MPSC_HDR_SIZE));
+        head += need - total;
+    }
+
+    lm_atomic_store_relaxed(__mpsc_hdr(p_rb, head), (uint32_t)length);
+
+    return &p_rb->buffer[(head & p_rb->mask) + __MPSC_HDR_SIZE];
+}
+
+/**
+ * @brief 提交已填写的记录
+ */
+void lm_ringbuf_mpsc_commit (struct lm_ringbuf_mpsc *p_rb, void *p_data)
+{
+    uint32_t *p_hdr;
+
+    if (p_rb == NULL || p_data == NULL) {
+        return;
+    }
+
+    p_hdr = (uint32_t *)((uint8_t *)p_data - __MPSC_HDR_SIZE);
+
+    /* 数据写完后再置提交标志 */
+    lm_atomic_store_release(p_hdr,
+                            lm_atomic_load_relaxed(p_hdr) | __MPSC_FLAG_COMMIT);
+}
+
+/**
+ * @brief 写入一条记录
+ */
+size_t lm_ringbuf_mpsc_put (struct lm_ringbuf_mpsc *p_rb,
+                            const void             *ptr,
+                            size_t                  length)
+{
+    void *p_data;
+
+    if (ptr == NULL) {
+        return 0;
+    }
+
+    p_data = lm_ringbuf_mpsc_claim(p_rb, length);
+    if (p_data == NULL) {
+        return 0;
+    }
+
+    memcpy(p_data, ptr, length);
+    lm_ringbuf_mpsc_commit(p_rb, p_data);
+
+    return length;
+}
+
+/**
+ * @brief 释放计数tail处长度为length的记录, 返回新的tail
+ */
+static uint32_t __mpsc_free (struct lm_ringbuf_mpsc *p_rb,
+                             uint32_t                tail,
+                             uint32_t                length)
+{
+    uint32_t total = __MPSC_HDR_SIZE + __MPSC_ALIGN(length);
+
+    /* 记录不会跨越缓冲区末尾, 可以直接清零 */
+    memset(__mpsc_hdr(p_rb, tail), 0, total);
+
+    tail += total;
+    lm_atomic_store_release(&p_rb->tail, tail);
+
+    return tail;
+}
+
+/**
+ * @brief 查看最早的已提交记录
+ */
+const void *lm_ringbuf_mpsc_peek (struct lm_ringbuf_mpsc *p_rb,
+                                  size_t                 *p_length)
+{
+    uint32_t tail, hdr;
+
+    if (p_rb == NULL || p_length == NULL) {
+        return NULL;
+    }
+
+    tail = lm_atomic_load_relaxed(&p_rb->tail);
+
+    while (tail != lm_atomic_load_acquire(&p_rb->head)) {
+
+        hdr = lm_atomic_load_acquire(__mpsc_hdr(p_rb, tail));
+
+        /* 最早的记录还没有提交, 后面的记录即使提交了也要等待 */
+        if (!(hdr & __MPSC_FLAG_COMMIT)) {
+            return NULL;
+        }
+
+        if (hdr & __MPSC_FLAG_PAD) {
+            tail = __mpsc_free(p_rb, tail, hdr & __MPSC_LEN_MASK);
+            continue;
+        }
+
+        *p_length = hdr & __MPSC_LEN_MASK;
+
+        return &p_rb->buffer[(tail & p_rb->mask) + __MPSC_HDR_SIZE];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 释放lm_ringbuf_mpsc_peek()取到的记录
+ */
+void lm_ringbuf_mpsc_release (struct lm_ringbuf_mpsc *p_rb)
+{
+    uint32_t tail, hdr;
+
+    if (p_rb == NULL) {
+        return;
+    }
+
+    tail = lm_atomic_load_relaxed(&p_rb->tail);
+    if (tail == lm_atomic_load_acquire(&p_rb->head)) {
+        return;
+    }
+
+    hdr = lm_atomic_load_acquire(__mpsc_hdr(p_rb, tail));
+    if (!(hdr & __MPSC_FLAG_COMMIT)) {
+        return;
+    }
+
+    __mpsc_free(p_rb, tail, hdr & __MPSC_LEN_MASK);
+}
+
+/**
+ * @brief 读出一条已提交的记录
+ */
+size_t lm_ringbuf_mpsc_get (struct lm_ringbuf_mpsc *p_rb,
+                            void                   *ptr,
+                            size_t                  length)
+{
+    const void *p_data;
+    size_t      record_len;
+
+    if (ptr == NULL) {
+        return 0;
+    }
+
+    p_data = lm_ringbuf_mpsc_peek(p_rb, &record_len);
+    if (p_data == NULL) {
+        return 0;
+    }
+
+    if (length > record_len)
+        length = record_len;
+
+    memcpy(ptr, p_data, length);
+    lm_ringbuf_mpsc_release(p_rb);
+
+    return length;
+}
+
+/* end of file */
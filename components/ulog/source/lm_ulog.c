@@ -42,47 +42,66 @@ static int __ulog_vsout (   const char      *pre,   \
                             va_list         va)
 {
     int ret = LM_OK;
+    int cnt = 0;
 
     lm_tm_t datetime;
+    char    stamp[20];
+    int     len;
+
+    struct lm_serial_iovec iov[7];
 
     /* 1. 参数有效性检查 */
     if (NULL == pre || NULL == name || NULL == __gp_ulog_info) {
         return -LM_ERROR;
     }
 
+    /*
+     * 各部分作为片段直接发送, 只有日志内容需要格式化到输出缓存
+     */
+
     /* 2. 打印时间戳 */
     if ((g_ulog_flag & LM_ULOG_FLAG_TIMESTAMP) && \
        (flag & LM_ULOG_FLAG_TIMESTAMP)) {
         lm_time_get(&datetime);
-        snprintf((void *)__gp_ulog_info->ulog_out_buf, __gp_ulog_info->ulog_s, \
+        snprintf(stamp, sizeof(stamp), \
                     "%02d %02d %02d:%02d:%02d ",
                     datetime.tm_mon, datetime.tm_yday, \
                     datetime.tm_hour, datetime.tm_min, datetime.tm_sec);
-    } else {
-        __gp_ulog_info->ulog_out_buf[0] = '\0';
+        iov[cnt].base  = stamp;
+        iov[cnt++].len = strlen(stamp);
     }
 
     /* 3. 打印日志级别 */
-    strcat((void *)__gp_ulog_info->ulog_out_buf, (void *)pre);
-    strcat((void *)__gp_ulog_info->ulog_out_buf, (void *)" ");
+    iov[cnt].base  = pre;
+    iov[cnt++].len = strlen(pre);
+    iov[cnt].base  = " ";
+    iov[cnt++].len = 1;
 
     /* 4. 打印设备或模块名称 */
     if ((g_ulog_flag & LM_ULOG_FLAG_NAME) && (flag & LM_ULOG_FLAG_NAME)) {
-        strcat((void *)__gp_ulog_info->ulog_out_buf, (void *)name);
-        strcat((void *)__gp_ulog_info->ulog_out_buf, (void *)" : ");
+        iov[cnt].base  = name;
+        iov[cnt++].len = strlen(name);
+        iov[cnt].base  = " : ";
+        iov[cnt++].len = 3;
     }
 
     /* 5. 打印日志内容 */
-    vsnprintf((void *)&(__gp_ulog_info[strlen((void *)__gp_ulog_info->ulog_out_buf)]), \
-            __gp_ulog_info->ulog_s - strlen(STRBR) - \
-            strlen((void *)__gp_ulog_info->ulog_out_buf) - 1, fmt, va);
+    len = vsnprintf((void *)__gp_ulog_info->ulog_out_buf, \
+                    __gp_ulog_info->ulog_s, fmt, va);
+    if (len > 0) {
+        if (len >= __gp_ulog_info->ulog_s) {
+            len = __gp_ulog_info->ulog_s - 1;
+        }
+        iov[cnt].base  = __gp_ulog_info->ulog_out_buf;
+        iov[cnt++].len = len;
+    }
 
     /* 6. 添加换行符 */
-    strcat((void *)__gp_ulog_info->ulog_out_buf, (void *)STRBR);
+    iov[cnt].base  = STRBR;
+    iov[cnt++].len = strlen(STRBR);
 
     /* 7. 打印 */
-    lm_serial_write(__gp_ulog_info->com, (void *)__gp_ulog_info->ulog_out_buf, \
-                    strlen((void *)__gp_ulog_info->ulog_out_buf));
+    lm_serial_writev(__gp_ulog_info->com, iov, cnt);
 
     /* 8. 检查日志是否需要保存 */
     switch (type) {
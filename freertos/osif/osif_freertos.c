@@ -72,7 +72,13 @@
 #define DEV_ASSERT(e) ((void)0)
 #endif
 
+#ifndef FEATURE_OSIF_FREERTOS_ISR_CONTEXT_METHOD
+#if defined(__unix__)
+#define FEATURE_OSIF_FREERTOS_ISR_CONTEXT_METHOD         (3) /* POSIX host port */
+#else
 #define FEATURE_OSIF_FREERTOS_ISR_CONTEXT_METHOD         (1) /* Cortex M device */
+#endif
+#endif
 
 #if !defined (USING_OS_FREERTOS)
 #error "Wrong OSIF selected. Please define symbol USING_OS_FREERTOS in project settings or change the OSIF variant"
@@ -134,6 +140,12 @@ static inline bool osif_IsIsrContext(void)
     bool is_isr = (bool)(interrupt_level > 0u);
     return is_isr;
 }
+#elif FEATURE_OSIF_FREERTOS_ISR_CONTEXT_METHOD == 3
+/* POSIX host port, interrupts are simulated by host threads */
+static inline bool osif_IsIsrContext(void)
+{
+    return (bool)(xPortIsInsideInterrupt() != pdFALSE);
+}
 #else
     #error "No method to check ISR Context"
 #endif /* FEATURE_OSIF_FREERTOS_ISR_CONTEXT_METHOD */
@@ -602,35 +614,40 @@ EventGroupHandle_t OSIF_EventCreate(void)
 
 /*FUNCTION**********************************************************************
  *
- * Function Name : OSIF_SemaPost
- * Description   : This function performs the 'post' (increment) operation on a semaphore.
+ * Function Name : OSIF_EventSet
+ * Description   : This function sets bits in an event group. Returns the bits
+ * set, or 0 if the request could not be posted from ISR context.
  *
- * Implements : OSIF_SemaPost_freertos_Activity
+ * Implements : OSIF_EventSet_freertos_Activity
  *END**************************************************************************/
 EventBits_t OSIF_EventSet(EventGroupHandle_t pEvent, const EventBits_t uxBitsToSet)
 {
     DEV_ASSERT(pEvent);
 
     BaseType_t operation_status = pdFAIL;
-    EventBits_t event_state;
+    EventBits_t event_state = 0;
 
     /* Check if the post operation is executed from ISR context */
     bool is_isr = osif_IsIsrContext();
     if (is_isr)
     {
-        /* Execution from exception handler (ISR) */
+        /* Execution from exception handler (ISR), the request is deferred to
+         * the timer daemon task and fails when its queue is full */
         BaseType_t taskWoken = pdFALSE;
         operation_status = xEventGroupSetBitsFromISR(pEvent, uxBitsToSet, &taskWoken);
         if (operation_status == pdPASS)
         {
+            event_state = uxBitsToSet;
             /* Perform a context switch if necessary */
             portYIELD_FROM_ISR(taskWoken);
         }
     }
     else
     {
-        /* Execution from task */
-        event_state = xEventGroupSetBits(pEvent, uxBitsToSet);
+        /* Execution from task, always succeeds. The bits may already be
+         * cleared again by the unblocked tasks, so return the requested bits */
+        (void)xEventGroupSetBits(pEvent, uxBitsToSet);
+        event_state = uxBitsToSet;
     }
 
     return event_state;
@@ -0,0 +1,355 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the POSIX (Linux)
+ * host port.
+ *
+ * Every task is a pthread.  The thread control block is placed at the top of
+ * the task stack, the kernel keeps a pointer to it in pxTopOfStack.  Only the
+ * thread whose xRunning flag is set may run, a context switch hands the flag
+ * to the thread of the task selected by vTaskSwitchContext() and parks the
+ * current thread until it gets the flag back.
+ *
+ * Critical sections are one host mutex which the simulated tick interrupt
+ * also takes, the nesting count is per thread.
+ *----------------------------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Host stack of a task thread, the task code runs on this stack. */
+#ifndef configPOSIX_THREAD_STACK_SIZE
+	#define configPOSIX_THREAD_STACK_SIZE	( 256 * 1024 )
+#endif
+
+typedef struct xTHREAD
+{
+	pthread_t xThread;
+	pthread_cond_t xCond;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+	BaseType_t xRunning;	/* The task owns the CPU. */
+	BaseType_t xDying;		/* The task has been deleted, the thread must exit. */
+} Thread_t;
+
+/* The first member of the TCB is pxTopOfStack, which points to the thread. */
+#define portTHREAD_OF( xTask )	( *( Thread_t ** ) ( xTask ) )
+
+/* Protects xRunning/xDying of all threads and the tick/end notifications. */
+static pthread_mutex_t xRunLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xTickCond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t xEndCond = PTHREAD_COND_INITIALIZER;
+static uint32_t ulTickEvents = 0;
+static BaseType_t xSchedulerEnded = pdFALSE;
+
+/* The critical section lock. */
+static pthread_mutex_t xCriticalMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t xTickThread;
+
+/* Per thread state. */
+static __thread Thread_t *pxThisThread = NULL;
+static __thread UBaseType_t uxCriticalNesting = 0;
+static __thread BaseType_t xSwitchPending = pdFALSE;
+static __thread BaseType_t xInsideInterrupt = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Park the calling thread until its task is selected to run.  Exits the thread
+ * if the task has been deleted meanwhile.  Called with xRunLock held, returns
+ * with it released.
+ */
+static void prvWaitToRun( Thread_t *pxThread )
+{
+BaseType_t xDying;
+
+	while( ( pxThread->xRunning == pdFALSE ) && ( pxThread->xDying == pdFALSE ) )
+	{
+		pthread_cond_wait( &pxThread->xCond, &xRunLock );
+	}
+	xDying = pxThread->xDying;
+	pthread_mutex_unlock( &xRunLock );
+
+	if( xDying != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Entry point of every task thread.
+ */
+static void *prvThreadStart( void *pvParameters )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParameters;
+
+	pxThisThread = pxThread;
+
+	pthread_mutex_lock( &xRunLock );
+	prvWaitToRun( pxThread );
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* A task must not return, delete it as the other ports would trap it. */
+	vTaskDelete( NULL );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Select the next task and hand the CPU over to it.  The idle task selected
+ * again waits for the next tick instead of spinning on the host CPU.
+ */
+static void prvSwitchContext( void )
+{
+Thread_t *pxSelf = pxThisThread;
+Thread_t *pxNext;
+uint32_t ulTick;
+
+	pthread_mutex_lock( &xCriticalMutex );
+	vTaskSwitchContext();
+	pxNext = portTHREAD_OF( xTaskGetCurrentTaskHandle() );
+	pthread_mutex_unlock( &xCriticalMutex );
+
+	pthread_mutex_lock( &xRunLock );
+
+	if( pxNext != pxSelf )
+	{
+		pxSelf->xRunning = pdFALSE;
+		pxNext->xRunning = pdTRUE;
+		pthread_cond_signal( &pxNext->xCond );
+		prvWaitToRun( pxSelf );
+	}
+	else if( xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle() )
+	{
+		ulTick = ulTickEvents;
+		while( ( ulTick == ulTickEvents ) && ( xSchedulerEnded == pdFALSE ) )
+		{
+			pthread_cond_wait( &xTickCond, &xRunLock );
+		}
+		pthread_mutex_unlock( &xRunLock );
+	}
+	else
+	{
+		pthread_mutex_unlock( &xRunLock );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The simulated tick interrupt.
+ */
+static void *prvTickThread( void *pvParameters )
+{
+struct timespec xNext;
+BaseType_t xEnded = pdFALSE;
+
+	( void ) pvParameters;
+
+	xInsideInterrupt = pdTRUE;
+	clock_gettime( CLOCK_MONOTONIC, &xNext );
+
+	while( xEnded == pdFALSE )
+	{
+		xNext.tv_nsec += 1000000000L / configTICK_RATE_HZ;
+		if( xNext.tv_nsec >= 1000000000L )
+		{
+			xNext.tv_nsec -= 1000000000L;
+			xNext.tv_sec++;
+		}
+		clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xNext, NULL );
+
+		/* The port is cooperative, a task unblocked by the tick runs when the
+		running task blocks or yields. */
+		vPortEnterCritical();
+		( void ) xTaskIncrementTick();
+		vPortExitCritical();
+
+		pthread_mutex_lock( &xRunLock );
+		ulTickEvents++;
+		pthread_cond_broadcast( &xTickCond );
+		xEnded = xSchedulerEnded;
+		pthread_mutex_unlock( &xRunLock );
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xAttr;
+int xResult;
+
+	/* Place the thread control block at the top of the stack. */
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxTopOfStack + 1 ) - sizeof( Thread_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+	memset( pxThread, 0, sizeof( Thread_t ) );
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pthread_cond_init( &pxThread->xCond, NULL );
+
+	/* The task code runs on the host thread stack, the FreeRTOS stack only
+	holds the thread control block. */
+	pthread_attr_init( &xAttr );
+	pthread_attr_setstacksize( &xAttr, configPOSIX_THREAD_STACK_SIZE );
+	xResult = pthread_create( &pxThread->xThread, &xAttr, prvThreadStart, pxThread );
+	pthread_attr_destroy( &xAttr );
+	configASSERT( xResult == 0 );
+	( void ) xResult;
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+Thread_t *pxFirst = portTHREAD_OF( xTaskGetCurrentTaskHandle() );
+
+	if( pthread_create( &xTickThread, NULL, prvTickThread, NULL ) != 0 )
+	{
+		return pdFAIL;
+	}
+
+	/* Start the first task and wait until vTaskEndScheduler() is called. */
+	pthread_mutex_lock( &xRunLock );
+	pxFirst->xRunning = pdTRUE;
+	pthread_cond_signal( &pxFirst->xCond );
+	while( xSchedulerEnded == pdFALSE )
+	{
+		pthread_cond_wait( &xEndCond, &xRunLock );
+	}
+	pthread_mutex_unlock( &xRunLock );
+
+	pthread_join( xTickThread, NULL );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+Thread_t *pxSelf = pxThisThread;
+
+	pthread_mutex_lock( &xRunLock );
+	xSchedulerEnded = pdTRUE;
+	pthread_cond_broadcast( &xEndCond );
+	pthread_cond_broadcast( &xTickCond );
+
+	/* Execution continues after vTaskStartScheduler(), the calling task never
+	runs again. */
+	if( pxSelf != NULL )
+	{
+		pxSelf->xRunning = pdFALSE;
+		for( ;; )
+		{
+			pthread_cond_wait( &pxSelf->xCond, &xRunLock );
+		}
+	}
+	pthread_mutex_unlock( &xRunLock );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	/* Yields inside a critical section (portYIELD_WITHIN_API) are performed
+	when the critical section is left. */
+	if( uxCriticalNesting != 0 )
+	{
+		xSwitchPending = pdTRUE;
+	}
+	else if( pxThisThread != NULL )
+	{
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	if( uxCriticalNesting == 0 )
+	{
+		pthread_mutex_lock( &xCriticalMutex );
+	}
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		pthread_mutex_unlock( &xCriticalMutex );
+
+		if( xSwitchPending != pdFALSE )
+		{
+			xSwitchPending = pdFALSE;
+			vPortYield();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+	return xInsideInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpTCB( void *pxTCB )
+{
+Thread_t *pxThread = portTHREAD_OF( pxTCB );
+
+	/* The thread is parked, wake it up to exit. */
+	pthread_mutex_lock( &xRunLock );
+	pxThread->xDying = pdTRUE;
+	pthread_cond_signal( &pxThread->xCond );
+	pthread_mutex_unlock( &xRunLock );
+
+	pthread_join( pxThread->xThread, NULL );
+	pthread_cond_destroy( &pxThread->xCond );
+}
+/*-----------------------------------------------------------*/
+
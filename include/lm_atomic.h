@@ -0,0 +1,67 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_atomic.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 原子操作模块(基于gcc内建__atomic函数)
+*******************************************************************************/
+
+#ifndef __LM_ATOMIC_H
+#define __LM_ATOMIC_H
+
+#include "lm_types.h"
+
+LM_BEGIN_EXTERN_C
+
+/*
+ * 对齐的32位字的读写在Cortex-M上本身就是原子的, 这里的宏主要用来约束
+ * 编译器和处理器的访问顺序:
+ *   acquire: 之后的读写不会被提前到该读操作之前
+ *   release: 之前的读写不会被推迟到该写操作之后
+ */
+
+/* 读(无顺序约束) */
+#define lm_atomic_load_relaxed(p)       __atomic_load_n((p), __ATOMIC_RELAXED)
+
+/* 读(acquire) */
+#define lm_atomic_load_acquire(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+
+/* 写(无顺序约束) */
+#define lm_atomic_store_relaxed(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+
+/* 写(release) */
+#define lm_atomic_store_release(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* 内存屏障: 屏障前的读不会被推迟到屏障后的读写之后(acquire) */
+#define lm_atomic_fence_acquire()       __atomic_thread_fence(__ATOMIC_ACQUIRE)
+
+/* 内存屏障: 屏障后的写不会被提前到屏障前的读写之前(release) */
+#define lm_atomic_fence_release()       __atomic_thread_fence(__ATOMIC_RELEASE)
+
+/*
+ * 比较并交换: *p等于*p_expected时写入v并返回真, 否则把*p的当前值存入
+ * *p_expected并返回假. 可能伪失败, 需要在循环中使用.
+ *
+ * ARMv6-M(Cortex-M0/M0+)没有LDREX/STREX, gcc会把它编译成libatomic调用,
+ * 该架构下不定义LM_ATOMIC_HAS_CAS, 使用者需要改用临界区.
+ */
+#if !defined(__ARM_ARCH_6M__)
+#define LM_ATOMIC_HAS_CAS               1
+
+#define lm_atomic_cas(p, p_expected, v) \
+        __atomic_compare_exchange_n((p), (p_expected), (v), true, \
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#endif
+
+LM_END_EXTERN_C
+
+#endif /* __LM_ATOMIC_H */
+
+/* end of file */
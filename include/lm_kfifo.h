@@ -0,0 +1,124 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_kfifo.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 大容量环形缓冲区模块(容量为2的幂)
+*******************************************************************************/
+
+#ifndef __LM_KFIFO_H
+#define __LM_KFIFO_H
+
+#include "lmiracle.h"
+
+LM_BEGIN_EXTERN_C
+
+/*
+ * 与lm_ringbuf相比:
+ *   1. 容量必须是2的幂, 最大可到2GiB, 不受15位索引的限制
+ *   2. in/out为自由增长的32位计数, 只在访问缓冲区时与mask相与,
+ *      数据长度即in - out(无符号回绕自动正确), 没有镜像位的分支
+ *   3. 长度参数和返回值都是size_t, 不会被截断
+ *
+ * 单生产者/单消费者时无需加锁: in只由生产者修改, out只由消费者修改.
+ */
+struct lm_kfifo
+{
+    uint8_t  *buffer;
+    uint32_t  mask;                 /* 容量 - 1 */
+    uint32_t  in;                   /* 写入计数 */
+    uint32_t  out;                  /* 读出计数 */
+};
+
+/**
+ * @brief 初始化kfifo(静态)
+ *
+ * @param[in] p_fifo kfifo指针
+ * @param[in] pool   缓冲区地址
+ * @param[in] size   缓冲区大小(必须是2的幂)
+ *
+ * @return LM_OK  成功
+ *         其他    失败
+ */
+extern int lm_kfifo_init (struct lm_kfifo *p_fifo, uint8_t *pool, size_t size);
+
+/**
+ * @brief 写入数据, 空间不足时只写入能放下的部分
+ *
+ * @param[in] p_fifo kfifo指针
+ * @param[in] ptr    需要写入数据的地址
+ * @param[in] length 需要写入数据的长度
+ *
+ * return 实际写入数据的长度
+ */
+extern size_t lm_kfifo_in (struct lm_kfifo *p_fifo,
+                           const void      *ptr,
+                           size_t           length);
+
+/**
+ * @brief 读出数据
+ *
+ * @param[in]  p_fifo kfifo指针
+ * @param[out] ptr    保存读出数据的地址
+ * @param[in]  length 希望读出数据的长度
+ *
+ * return 实际读出数据的长度
+ */
+extern size_t lm_kfifo_out (struct lm_kfifo *p_fifo,
+                            void            *ptr,
+                            size_t           length);
+
+/**
+ * @brief 查看数据(数据仍保留在kfifo中)
+ *
+ * @param[in]  p_fifo kfifo指针
+ * @param[out] ptr    保存数据的地址
+ * @param[in]  length 希望查看数据的长度
+ *
+ * return 实际查看数据的长度
+ */
+extern size_t lm_kfifo_out_peek (struct lm_kfifo *p_fifo,
+                                 void            *ptr,
+                                 size_t           length);
+
+/**
+ * @brief 获取kfifo中数据的长度
+ */
+extern size_t lm_kfifo_len (struct lm_kfifo *p_fifo);
+
+/**
+ * @brief 复位kfifo
+ *
+ * @note 调用时生产者和消费者都不能访问该kfifo
+ */
+extern void lm_kfifo_reset (struct lm_kfifo *p_fifo);
+
+/**
+ * @brief 获取kfifo的容量
+ */
+static inline size_t lm_kfifo_size (struct lm_kfifo *p_fifo)
+{
+    if (p_fifo == NULL) {
+        return 0;
+    }
+
+    return (size_t)p_fifo->mask + 1;
+}
+
+/**
+ * @brief 返回kfifo的空闲空间
+ */
+#define lm_kfifo_avail(p_fifo) (lm_kfifo_size(p_fifo) - lm_kfifo_len(p_fifo))
+
+LM_END_EXTERN_C
+
+#endif /* __LM_KFIFO_H */
+
+/* end of file */
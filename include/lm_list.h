@@ -37,6 +37,7 @@ struct lm_list_head {
 
 static inline void LM_INIT_LIST_HEAD (struct lm_list_head *list)
 {
+    list->next = list;
     list->prev = list;
 }
 
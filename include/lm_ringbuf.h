@@ -7,6 +7,7 @@
 * Change Logs   :
 * Date          Author          Notes
 * 2019-06-07    linxuew         V1.0    first version
+* 2026-10-17    agent           V1.1    SPSC lock-free indices
 *******************************************************************************/
 
 /*******************************************************************************
@@ -20,6 +21,28 @@
 
 LM_BEGIN_EXTERN_C
 
+/* 是否使能环形缓冲区统计(水位, 丢弃, 覆盖, 吞吐量) */
+#ifndef LM_RINGBUF_STAT_ENABLED
+#define LM_RINGBUF_STAT_ENABLED     0
+#endif
+
+/* 是否编译环形缓冲区性能测试(lm_ringbuf_bench) */
+#ifndef LM_RINGBUF_BENCH_ENABLED
+#define LM_RINGBUF_BENCH_ENABLED    0
+#endif
+
+/* ring buffer statistics */
+struct lm_ringbuf_stat
+{
+    uint32_t high_water;            /* 最高水位(字节) */
+    uint32_t dropped;               /* 空间不足被丢弃的字节数 */
+    uint32_t overwrite_count;       /* 强制写覆盖旧数据的次数 */
+    uint32_t overwritten;           /* 被覆盖的旧数据字节数 */
+    uint32_t truncated;             /* 强制写的输入超过容量被截掉的字节数 */
+    uint32_t total_in;              /* 累计写入字节数 */
+    uint32_t total_out;             /* 累计读出字节数 */
+};
+
 /* ring buffer */
 struct lm_ringbuf
 {
@@ -36,13 +59,39 @@ struct lm_ringbuf
      * +---+---+---+---+---+---+---+|+~~~+~~~+~~~+~~~+~~~+~~~+~~~+
      * read_idx-^ ^-write_idx
      *
+     * 镜像位折叠进索引中, 索引取值范围为[0, 2 * buffer_size),
+     * 索引 >= buffer_size 即表示处于mirror = 1一侧.
+     *
+     * 单生产者/单消费者(SPSC)无锁约定:
+     *   write_index 只由生产者修改(release发布), 消费者acquire读取
+     *   read_index  只由消费者修改(release发布), 生产者acquire读取
+     * 两个索引各自独占一个对齐的32位字, 读写都是原子的, 因此中断(生产者)
+     * 和任务(消费者)之间不需要进入临界区.
+     *
+     * 强制写和DMA覆盖未读数据时, 生产者也不修改读索引, 而是递增overrun_seq
+     * (覆盖期间为奇数). 消费者发现overrun_seq与自己的overrun_ack不同时,
+     * 把读索引重新同步到最新的一整圈数据; 拷贝期间overrun_seq变化则丢弃
+     * 本次读出的数据重读. 消费者同步之前, 生产者按缓冲区已满处理.
      */
-    uint16_t read_mirror : 1;
-    uint16_t read_index : 15;
-    uint16_t write_mirror : 1;
-    uint16_t write_index : 15;
+    uint32_t read_index;
+    uint32_t write_index;
+
+    uint32_t overrun_seq;           /* 覆盖序号, 只由生产者修改 */
+    uint32_t overrun_ack;           /* 已同步的覆盖序号, 只由消费者修改 */
 
     int16_t buffer_size;
+
+#if LM_RINGBUF_STAT_ENABLED
+    /* 写入相关的计数只由生产者修改, total_out只由消费者修改 */
+    struct lm_ringbuf_stat stat;
+#endif
+};
+
+/* 环形缓冲区中的一段连续空间(零拷贝访问) */
+struct lm_ringbuf_span
+{
+    uint8_t *ptr;
+    size_t   len;
 };
 
 enum lm_ringbuf_state
@@ -58,7 +107,7 @@ enum lm_ringbuf_state
  *
  * @param[in] p_rb   环形缓冲区指针
  * @param[in] pool   环形缓冲区地址
- * @param[in] size   环形缓冲区大小
+ * @param[in] size   环形缓冲区大小(不超过32767, 更大的缓冲区请使用lm_kfifo)
  *
  * @return LM_OK  成功
  *         其他    失败
@@ -82,6 +131,8 @@ extern size_t lm_ringbuf_put (struct lm_ringbuf *p_rb,
 /**
  * @brief 将数据写入环形缓存区,如果满了，覆盖以前数据
  *
+ * @note 覆盖时不修改读索引, 由消费者根据覆盖序号重新同步, 与消费者并发时不需要加锁
+ *
  * @param[in] p_rb   环形缓冲区指针
  * @param[in] ptr    需要写入数据的地址
  * @param[in] length 需要写入数据的长度
@@ -122,6 +173,8 @@ extern size_t lm_ringbuf_putchar (struct lm_ringbuf *p_rb, const uint8_t ch);
 /**
  * @brief 将一个字节强制写入到环形缓存区
  *
+ * @note 覆盖时不修改读索引, 由消费者根据覆盖序号重新同步, 与消费者并发时不需要加锁
+ *
  * @param[in] p_rb 环形缓冲区指针
  * @param[in] ch   需要写入的字符
  *
@@ -141,6 +194,122 @@ extern size_t lm_ringbuf_putchar_force (struct lm_ringbuf *p_rb, const uint8_t c
  */
 extern size_t lm_ringbuf_getchar (struct lm_ringbuf *p_rb, uint8_t *ch);
 
+/**
+ * @brief 预留可写空间(零拷贝写, 生产者使用)
+ *
+ * 不拷贝数据, 而是直接返回缓冲区中可写的空间, 由调用者(DMA或协议层)
+ * 直接写入, 写完后调用lm_ringbuf_commit()发布. 空间跨越缓冲区末尾时
+ * 分成两段返回, 不回绕时span[1].len为0.
+ *
+ * @param[in]  p_rb   环形缓冲区指针
+ * @param[in]  length 希望预留的长度
+ * @param[out] span   两段连续空间
+ *
+ * return 实际预留的长度(不超过空闲空间)
+ */
+extern size_t lm_ringbuf_reserve (struct lm_ringbuf      *p_rb,
+                                  size_t                  length,
+                                  struct lm_ringbuf_span  span[2]);
+
+/**
+ * @brief 提交已写入预留空间的数据
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] length 已写入的长度(从预留空间起始处算起)
+ *
+ * return 实际提交的长度
+ */
+extern size_t lm_ringbuf_commit (struct lm_ringbuf *p_rb, size_t length);
+
+/**
+ * @brief 查看可读数据(零拷贝读, 消费者使用)
+ *
+ * 数据仍保留在缓冲区中, 处理完后调用lm_ringbuf_consume()释放.
+ * 数据跨越缓冲区末尾时分成两段返回, 不回绕时span[1].len为0.
+ *
+ * @param[in]  p_rb   环形缓冲区指针
+ * @param[out] span   两段连续数据
+ *
+ * return 可读数据的总长度
+ */
+extern size_t lm_ringbuf_peek_contig (struct lm_ringbuf      *p_rb,
+                                      struct lm_ringbuf_span  span[2]);
+
+/**
+ * @brief 释放已处理的数据
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] length 需要释放的长度
+ *
+ * return 实际释放的长度(查看之后数据被强制写或DMA覆盖时返回0, 查看到的数据已失效)
+ */
+extern size_t lm_ringbuf_consume (struct lm_ringbuf *p_rb, size_t length);
+
+/**
+ * @brief 根据DMA硬件写位置发布数据(循环DMA接收, 生产者使用)
+ *
+ * DMA以循环模式直接写入环形缓冲区的存储区(存储区大小即DMA传输长度),
+ * 在半传输/传输完成/空闲线事件中以DMA当前写位置调用该函数, 只移动写索引,
+ * CPU不搬运数据. 两次调用之间DMA写入的数据不能超过一整圈.
+ * DMA覆盖了尚未读出的数据时只递增覆盖序号, 消费者下次读取时丢掉最早的数据,
+ * 从最新的一整圈数据开始读(同put_force).
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] offset DMA当前写位置(相对存储区起始的偏移, 一般为size - 剩余计数)
+ *
+ * return 新发布的数据长度
+ */
+extern size_t lm_ringbuf_dma_update (struct lm_ringbuf *p_rb, uint32_t offset);
+
+/*
+ * 记录(消息)模式: 每条记录前带1~2字节的长度头, 长度小于128时为1字节,
+ * 否则为2字节(最高位置1). 记录整条写入整条读出, 同一个环形缓冲区中
+ * 不能与按字节读写的接口混用.
+ */
+
+/* 单条记录的最大长度 */
+#define LM_RINGBUF_RECORD_MAX       0x7FFF
+
+/**
+ * @brief 写入一条记录, 空间不足时整条丢弃
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] ptr    记录数据的地址
+ * @param[in] length 记录数据的长度(1 ~ LM_RINGBUF_RECORD_MAX), 不允许空记录
+ *
+ * return 大于０ : 写入记录的长度
+ *        等于０ : 空间不足
+ *        小于０ : 错误码(length为0时返回-LM_EINVAL)
+ */
+extern size_t lm_ringbuf_put_record (struct lm_ringbuf *p_rb,
+                                     const uint8_t     *ptr,
+                                     uint16_t           length);
+
+/**
+ * @brief 读出一条记录
+ *
+ * @param[in]  p_rb   环形缓冲区指针
+ * @param[out] ptr    保存记录数据的地址
+ * @param[in]  length 缓存区长度(至少为1), 小于记录长度时截断, 剩余部分丢弃
+ *
+ * return 大于０ : 读出数据的长度
+ *        等于０ : 没有记录(记录长度至少为1, 不会与空记录混淆)
+ *        小于０ : 错误码, 参数错误返回-LM_EINVAL; 长度头损坏返回-LM_EIO,
+ *                 此时缓冲区中已写入的数据全部丢弃, 之后写入的记录可以正常读出
+ */
+extern size_t lm_ringbuf_get_record (struct lm_ringbuf *p_rb,
+                                     uint8_t           *ptr,
+                                     uint16_t           length);
+
+/**
+ * @brief 获取下一条记录的长度(不读出)
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ *
+ * return 下一条记录的长度, 没有记录时返回0
+ */
+extern size_t lm_ringbuf_peek_record_len (struct lm_ringbuf *p_rb);
+
 /**
  * @brief 获取环形缓存区数据长度
  *
@@ -155,11 +324,54 @@ extern size_t lm_ringbuf_data_len (struct lm_ringbuf *p_rb);
 /**
  * @brief 复位环形缓存区
  *
+ * @note 同时修改读写索引, 调用时生产者和消费者都不能访问该缓冲区
+ *
  * @param[in]  p_rb   环形缓冲区指针
  */
 extern void lm_ringbuf_reset (struct lm_ringbuf *p_rb);
 
 
+/**
+ * @brief 获取环形缓存区统计
+ *
+ * @param[in]  p_rb   环形缓冲区指针
+ * @param[out] p_stat 存放统计数据的地址
+ *
+ * @return LM_OK        成功
+ *         -LM_ENOTSUP  未使能LM_RINGBUF_STAT_ENABLED
+ */
+extern int lm_ringbuf_get_stat (struct lm_ringbuf      *p_rb,
+                                struct lm_ringbuf_stat *p_stat);
+
+/**
+ * @brief 清除环形缓存区统计(最高水位从当前数据长度重新开始)
+ *
+ * @param[in]  p_rb   环形缓冲区指针
+ */
+extern void lm_ringbuf_clear_stat (struct lm_ringbuf *p_rb);
+
+#if LM_RINGBUF_BENCH_ENABLED
+/**
+ * @brief 环形缓冲区性能测试
+ *
+ * 对put/get/putchar/getchar/put_force在不同缓冲区大小, 块大小和
+ * 回绕位置下计时, 通过lm_kprintf按CSV格式输出:
+ *   op,buf,chunk,offset,ops,ms,kbytes_per_s,ns_per_op,raw_ns_per_op
+ * kbytes_per_s以1000字节为单位. put/get的ns_per_op和kbytes_per_s已扣除
+ * 同条件下commit + consume的基准开销; putchar/getchar(含一次consume(1)
+ * 或commit(1))和put_force不扣除基准. raw_ns_per_op是未扣除基准的实测值,
+ * ns值保留两位小数.
+ * 主机上可以用tests/host/bench_ringbuf.c运行同一套测试.
+ *
+ * @param[in] pool      测试用缓冲区(最大测试4096字节)
+ * @param[in] pool_size 测试用缓冲区大小
+ *
+ * @return LM_OK  成功
+ *         其他    失败
+ */
+extern int lm_ringbuf_bench (uint8_t *pool, size_t pool_size);
+#endif
+
 /**
  * @brief 获取环形缓存区的长度
  *
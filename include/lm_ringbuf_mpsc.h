@@ -0,0 +1,126 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_ringbuf_mpsc.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 多生产者/单消费者记录环形缓冲区模块
+*******************************************************************************/
+
+#ifndef __LM_RINGBUF_MPSC_H
+#define __LM_RINGBUF_MPSC_H
+
+#include "lmiracle.h"
+
+LM_BEGIN_EXTERN_C
+
+/*
+ * 使用流程:
+ *   生产者(任意任务或中断): lm_ringbuf_mpsc_claim()申请空间 -> 填写数据
+ *                          -> lm_ringbuf_mpsc_commit()提交
+ *   消费者(唯一的排空任务): lm_ringbuf_mpsc_peek()取最早的记录 -> 转发
+ *                          -> lm_ringbuf_mpsc_release()释放
+ *
+ * 申请空间只是对head做一次比较并交换(Cortex-M0上为很短的临界区),
+ * 填写数据时各生产者互不阻塞. 消费者按申请顺序取记录, 遇到尚未提交
+ * 的记录就停下, 因此输出顺序与申请顺序一致.
+ *
+ * 每条记录前有4字节的记录头, 记录按4字节对齐, 放不下时在缓冲区末尾
+ * 填充一条空记录后从头开始. 缓冲区大小必须是2的幂, 地址必须4字节对齐,
+ * 单条记录最长为缓冲区大小的一半减去记录头.
+ */
+struct lm_ringbuf_mpsc
+{
+    uint8_t  *buffer;
+    uint32_t  mask;                 /* 容量 - 1 */
+    uint32_t  head;                 /* 申请计数(所有生产者竞争) */
+    uint32_t  tail;                 /* 释放计数(只由消费者修改) */
+};
+
+/**
+ * @brief 初始化多生产者环形缓冲区(静态)
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] pool   缓冲区地址(4字节对齐)
+ * @param[in] size   缓冲区大小(2的幂, 不小于16)
+ *
+ * @return LM_OK  成功
+ *         其他    失败
+ */
+extern int lm_ringbuf_mpsc_init (struct lm_ringbuf_mpsc *p_rb,
+                                 uint8_t                *pool,
+                                 size_t                  size);
+
+/**
+ * @brief 申请一条记录的空间(生产者)
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] length 记录长度
+ *
+ * @return 记录数据的地址, 空间不足时返回NULL
+ */
+extern void *lm_ringbuf_mpsc_claim (struct lm_ringbuf_mpsc *p_rb, size_t length);
+
+/**
+ * @brief 提交已填写的记录(生产者)
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] p_data lm_ringbuf_mpsc_claim()返回的地址
+ */
+extern void lm_ringbuf_mpsc_commit (struct lm_ringbuf_mpsc *p_rb, void *p_data);
+
+/**
+ * @brief 写入一条记录(申请, 拷贝, 提交)
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ * @param[in] ptr    记录数据的地址
+ * @param[in] length 记录长度
+ *
+ * return 写入记录的长度, 空间不足时返回0(整条丢弃)
+ */
+extern size_t lm_ringbuf_mpsc_put (struct lm_ringbuf_mpsc *p_rb,
+                                   const void             *ptr,
+                                   size_t                  length);
+
+/**
+ * @brief 查看最早的已提交记录(消费者)
+ *
+ * @param[in]  p_rb     环形缓冲区指针
+ * @param[out] p_length 记录长度
+ *
+ * @return 记录数据的地址, 没有已提交的记录时返回NULL
+ */
+extern const void *lm_ringbuf_mpsc_peek (struct lm_ringbuf_mpsc *p_rb,
+                                         size_t                 *p_length);
+
+/**
+ * @brief 释放lm_ringbuf_mpsc_peek()取到的记录(消费者)
+ *
+ * @param[in] p_rb   环形缓冲区指针
+ */
+extern void lm_ringbuf_mpsc_release (struct lm_ringbuf_mpsc *p_rb);
+
+/**
+ * @brief 读出一条已提交的记录(消费者)
+ *
+ * @param[in]  p_rb   环形缓冲区指针
+ * @param[out] ptr    保存记录数据的地址
+ * @param[in]  length 缓存区长度, 小于记录长度时截断, 剩余部分丢弃
+ *
+ * return 读出数据的长度, 没有已提交的记录时返回0
+ */
+extern size_t lm_ringbuf_mpsc_get (struct lm_ringbuf_mpsc *p_rb,
+                                   void                   *ptr,
+                                   size_t                  length);
+
+LM_END_EXTERN_C
+
+#endif /* __LM_RINGBUF_MPSC_H */
+
+/* end of file */
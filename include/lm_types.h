@@ -54,6 +54,11 @@ LM_BEGIN_EXTERN_C
 #define __packed    __attribute__((packed))
 #endif
 
+/* 按字节对齐宏定义 */
+#ifndef __aligned
+#define __aligned(n)    __attribute__((aligned(n)))
+#endif
+
 /* 不使用宏定义 */
 #ifndef __unused
 #define __unused    __attribute__((unused))
@@ -113,6 +113,11 @@ typedef  mutex_t lm_mutex_t;
  */
 #define lm_mutex_unlock(p_mutex)            OSIF_MutexUnlock(p_mutex);
 
+/**
+ * @brief 删除互斥锁
+ */
+#define lm_mutex_destroy(p_mutex)           OSIF_MutexDestroy(p_mutex)
+
 /**
  * @brief 信号量类型
  */
@@ -155,6 +160,11 @@ typedef semaphore_t lm_semb_t;
  */
 #define lm_semb_take(semb,timeout)          OSIF_SembWait(semb, timeout)
 
+/**
+ * @brief 删除二值信号量
+ */
+#define lm_semb_destroy(semb)               OSIF_SembDestroy(semb)
+
 /**
  * @brief 事件组类型
  */
@@ -191,6 +201,7 @@ typedef EventBits_t         lm_bits_t;
  * @brief 清除事件组标志
  */
 #define lm_event_clear(event, bits)         OSIF_EventClear(event, bits)
+
 /**
  * @brief 进入临界区
  */
@@ -201,6 +212,16 @@ typedef EventBits_t         lm_bits_t;
  */
 #define lm_critical_exit()                  vPortExitCritical()
 
+/**
+ * @brief 进入临界区(任务和中断中都可以使用), 返回进入前的中断屏蔽状态
+ */
+#define lm_critical_enter_isr()             taskENTER_CRITICAL_FROM_ISR()
+
+/**
+ * @brief 退出临界区(与lm_critical_enter_isr()配对使用)
+ */
+#define lm_critical_exit_isr(state)         taskEXIT_CRITICAL_FROM_ISR(state)
+
 /**
  * @brief 判断是否是中断上下文
  */
@@ -232,6 +253,152 @@ lm_tick_to_ms(lm_tick_t tick)
     return (unsigned int)t;
 }
 
+/**
+ * @brief 微秒时间戳是否来自CPU周期计数器
+ *
+ * Cortex-M3/M4/M7使用DWT周期计数器, 按configCPU_CLOCK_HZ换算;
+ * 其他内核(如Cortex-M0)没有周期计数器, 退化为系统节拍, 只有节拍精度
+ */
+#if (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)) && \
+    defined(configCPU_CLOCK_HZ)
+#define LM_US_STAMP_CYCLES                  1
+#else
+#define LM_US_STAMP_CYCLES                  0
+#endif
+
+/**
+ * @brief 获取微秒时间戳, 只用于和lm_us_elapsed()配合测量短时间的耗时
+ *
+ * 周期计数器在首次调用时打开, 32位回绕, 一次测量不能超过2^32个CPU周期
+ */
+static inline uint32_t lm_us_stamp (void)
+{
+#if LM_US_STAMP_CYCLES
+    if (!(readl_relaxed((void *)0xE0001000) & 0x01)) {      /* DWT_CTRL.CYCCNTENA */
+        writel_relaxed(readl_relaxed((void *)0xE000EDFC) | BIT(24),
+                       (void *)0xE000EDFC);                 /* DEMCR.TRCENA */
+        writel_relaxed(readl_relaxed((void *)0xE0001000) | 0x01,
+                       (void *)0xE0001000);
+    }
+
+    return readl_relaxed((void *)0xE0001004);               /* DWT_CYCCNT */
+#else
+    return lm_sys_get_tick();
+#endif
+}
+
+/**
+ * @brief 从时间戳stamp到现在经过的微秒数
+ */
+static inline uint32_t lm_us_elapsed (uint32_t stamp)
+{
+#if LM_US_STAMP_CYCLES
+    return (lm_us_stamp() - stamp) / ((uint32_t)configCPU_CLOCK_HZ / 1000000u);
+#else
+    return lm_tick_to_ms(lm_sys_get_tick() - stamp) * 1000u;
+#endif
+}
+
+/**
+ * @brief 任务句柄类型
+ */
+typedef TaskHandle_t lm_task_handle_t;
+
+/**
+ * @brief 获取当前任务句柄
+ */
+#define lm_task_self()                      xTaskGetCurrentTaskHandle()
+
+/**
+ * @brief 当前是否在中断中(与OSIF相同, Cortex-M上读IPSR)
+ *
+ * lm_is_int_context()目前固定为0, 任务通知需要真实区分上下文
+ */
+static inline bool __lm_in_isr (void)
+{
+#if defined(__arm__)
+    uint32_t ipsr;
+
+    __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+
+    return ipsr != 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief 等待任务通知中的bits位, 返回后只清除bits位
+ *
+ * 任务通知值是任务内所有模块共用的, 这里不动其他位: 只收到其他位时
+ * 继续等待剩余的时间, 返回前把其他位重新标记为待处理.
+ *
+ * @param[in]  bits    等待的位
+ * @param[out] p_bits  收到的bits中的位, 可以为NULL
+ * @param[in]  timeout 超时(ms), LM_SEM_WAIT_FOREVER:永久等待
+ *
+ * @return LM_OK 收到通知, -LM_ETIMEOUT 超时
+ */
+static inline int lm_task_notify_wait (uint32_t bits, uint32_t *p_bits, uint32_t timeout)
+{
+    TickType_t ticks = (timeout == LM_SEM_WAIT_FOREVER) ?
+                       portMAX_DELAY : (TickType_t)lm_ms_to_tick(timeout);
+    TimeOut_t  time_out;
+    uint32_t   value, others = 0;
+    int        ret = -LM_ETIMEOUT;
+
+    vTaskSetTimeOutState(&time_out);
+
+    while (xTaskNotifyWait(0, bits, &value, ticks) == pdTRUE) {
+        others |= value & ~bits;
+        if (value & bits) {
+            if (p_bits != NULL) {
+                *p_bits = value & bits;
+            }
+            ret = LM_OK;
+            break;
+        }
+
+        if (xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE) {
+            break;
+        }
+    }
+
+    /* 其他位仍在通知值中, 恢复待处理状态, 其他模块等待时能立即返回 */
+    if (others) {
+        xTaskNotify(xTaskGetCurrentTaskHandle(), 0, eSetBits);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 清除当前任务通知值中未处理的bits位, 其他位保持不变
+ */
+static inline void lm_task_notify_clear (uint32_t bits)
+{
+    uint32_t value;
+
+    if ((xTaskNotifyWait(0, bits, &value, 0) == pdTRUE) && (value & ~bits)) {
+        xTaskNotify(xTaskGetCurrentTaskHandle(), 0, eSetBits);
+    }
+}
+
+/**
+ * @brief 向任务发送通知(通知值按位或上bits), 任务和中断中都可以调用
+ */
+static inline void lm_task_notify (lm_task_handle_t task, uint32_t bits)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (__lm_in_isr()) {
+        xTaskNotifyFromISR(task, bits, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotify(task, bits, eSetBits);
+    }
+}
+
 static inline void lm_udelay (uint32_t us)
 {
     while(us--) {
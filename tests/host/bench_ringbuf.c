@@ -0,0 +1,49 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : bench_ringbuf.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 环形缓冲区性能测试(主机)
+*
+* 编译运行(在仓库根目录):
+*   gcc -std=gnu99 -O2 -pthread -DLM_RINGBUF_BENCH_ENABLED=1 \
+*       -include tests/host/lm_host.h -Iinclude \
+*       tests/host/bench_ringbuf.c components/src/lm_ringbuf.c \
+*       components/src/lm_ringbuf_bench.c -o bench_ringbuf && ./bench_ringbuf
+*
+* 与目标板上的rbbench命令输出相同格式的CSV. 同一台机器, 同样的编译选项
+* 下的结果可以在不同提交之间对比; 主机结果不能代表目标板上的性能.
+*******************************************************************************/
+
+#include "lm_ringbuf.h"
+#include "lm_kservice.h"
+
+pthread_mutex_t __g_lm_host_critical = PTHREAD_MUTEX_INITIALIZER;
+
+static uint8_t __g_pool[4096];
+
+/**
+ * @brief 输出到标准输出
+ */
+void lm_kprintf (const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+int main (void)
+{
+    return (lm_ringbuf_bench(__g_pool, sizeof(__g_pool)) == LM_OK) ? 0 : 1;
+}
+
+/* end of file */
@@ -0,0 +1,64 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : lm_host.h
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 主机测试环境(用pthread代替FreeRTOS)
+*******************************************************************************/
+
+#ifndef __LM_HOST_H
+#define __LM_HOST_H
+
+/*
+ * 通过gcc -include lm_host.h在所有源文件之前包含, 占用lmiracle.h的
+ * 头文件保护宏, 被测模块包含的lmiracle.h就不会再引入FreeRTOS.
+ */
+#define __LMIRACLE_H
+
+#include "lm_types.h"
+#include "lm_error.h"
+#include <pthread.h>
+#include <time.h>
+
+typedef long     lm_base_t;
+typedef uint32_t lm_tick_t;
+
+extern pthread_mutex_t __g_lm_host_critical;
+
+#define lm_critical_enter()         pthread_mutex_lock(&__g_lm_host_critical)
+#define lm_critical_exit()          pthread_mutex_unlock(&__g_lm_host_critical)
+#define lm_critical_enter_isr()     (pthread_mutex_lock(&__g_lm_host_critical), 0)
+#define lm_critical_exit_isr(state) ((void)(state), \
+                                     pthread_mutex_unlock(&__g_lm_host_critical))
+
+#define dma_rmb()                   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define lm_assert(exp)              ((void)0)
+
+/**
+ * @brief 系统节拍(1ms)
+ */
+static inline lm_tick_t lm_sys_get_tick (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (lm_tick_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static inline uint32_t lm_tick_to_ms (lm_tick_t tick)
+{
+    return tick;
+}
+
+#endif /* __LM_HOST_H */
+
+/* end of file */
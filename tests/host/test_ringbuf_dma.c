@@ -0,0 +1,251 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : test_ringbuf_dma.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 环形缓冲区循环DMA接收测试(主机, 用线程模拟DMA)
+*
+* 编译运行(在仓库根目录):
+*   gcc -std=gnu99 -O2 -pthread -fsanitize=address \
+*       -include tests/host/lm_host.h -Iinclude \
+*       tests/host/test_ringbuf_dma.c components/src/lm_ringbuf.c \
+*       -o test_ringbuf_dma && ./test_ringbuf_dma
+*
+* 模拟DMA的线程按32位字把递增计数写入存储区, 每写一块调用一次
+* lm_ringbuf_dma_update(). 消费者线程用拷贝和零拷贝接口读取:
+*   1. 不溢出: DMA只在有空闲空间时写入, 消费者逐字校验
+*   2. 溢出:   DMA不等待消费者, 持续覆盖未读数据. 真实DMA覆盖正在被读的
+*              数据时内容无法保证, 这里只校验单次读出不超过缓冲区容量,
+*              以及DMA停止后消费者读到的数据连续, 并且以最后写入的数据结束
+*   3. 单线程确定性检查: 覆盖后从最新一整圈开始读, 查看后被覆盖的数据
+*      不能再释放
+*******************************************************************************/
+
+#include "lm_ringbuf.h"
+#include <sched.h>
+
+pthread_mutex_t __g_lm_host_critical = PTHREAD_MUTEX_INITIALIZER;
+
+/* 存储区字数(即DMA传输长度) */
+#define __TEST_WORDS        251
+
+/* 每个阶段DMA写入的字数 */
+#define __TEST_TOTAL        4000000UL
+
+static struct lm_ringbuf __g_rb;
+static uint32_t          __g_pool[__TEST_WORDS];
+static volatile int      __g_overrun;
+static volatile int      __g_dma_done;
+
+#define __TEST_FAIL(...)    do { printf("FAIL: " __VA_ARGS__); exit(1); } while (0)
+
+/**
+ * @brief 线性同余伪随机数
+ */
+static uint32_t __test_rand (uint32_t *p_seed)
+{
+    *p_seed = *p_seed * 1103515245u + 12345u;
+
+    return *p_seed >> 16;
+}
+
+/**
+ * @brief 模拟DMA: 从pos开始写入n个字, 返回新的写位置
+ */
+static uint32_t __test_dma_write (uint32_t pos, uint32_t n, uint32_t *p_counter)
+{
+    while (n--) {
+        __atomic_store_n(&__g_pool[pos], ++*p_counter, __ATOMIC_RELAXED);
+        if (++pos == __TEST_WORDS) {
+            pos = 0;
+        }
+    }
+
+    return pos;
+}
+
+/**
+ * @brief 模拟DMA的线程
+ */
+static void *__test_dma (void *p_arg)
+{
+    uint32_t counter = 0, pos = 0, seed = 3, n;
+
+    (void)p_arg;
+
+    while (counter < __TEST_TOTAL) {
+        n = __test_rand(&seed) % (__TEST_WORDS / 4) + 1;
+        if (n > __TEST_TOTAL - counter) {
+            n = __TEST_TOTAL - counter;
+        }
+
+        if (!__g_overrun &&
+            lm_ringbuf_data_len(&__g_rb) + n * 4 > sizeof(__g_pool)) {
+            sched_yield();
+            continue;
+        }
+
+        pos = __test_dma_write(pos, n, &counter);
+        lm_ringbuf_dma_update(&__g_rb, pos * 4);
+
+        /* 让消费者有机会在覆盖的同时读取 */
+        if (__g_overrun && (n & 1)) {
+            sched_yield();
+        }
+    }
+
+    __atomic_store_n(&__g_dma_done, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/**
+ * @brief 读取最多n个字, 返回读出的字数
+ */
+static size_t __test_read (uint32_t *p_buf, size_t n, uint32_t *p_seed)
+{
+    struct lm_ringbuf_span span[2];
+    uint8_t               *p_dst = (uint8_t *)p_buf;
+    size_t                 r, i;
+
+    if (__test_rand(p_seed) & 1) {
+        r = lm_ringbuf_get(&__g_rb, p_dst, n * 4);
+    } else {
+        r = lm_ringbuf_peek_contig(&__g_rb, span);
+        if (r > n * 4) {
+            r = n * 4;
+        }
+        for (i = 0; i < r; i++) {
+            p_dst[i] = (i < span[0].len) ? span[0].ptr[i] : span[1].ptr[i - span[0].len];
+        }
+        r = lm_ringbuf_consume(&__g_rb, r);
+    }
+
+    if (r > sizeof(__g_pool)) {
+        __TEST_FAIL("read %u bytes from a %u byte ring\n",
+                    (unsigned)r, (unsigned)sizeof(__g_pool));
+    }
+    if (r % 4) {
+        __TEST_FAIL("read %u bytes, not word aligned\n", (unsigned)r);
+    }
+
+    return r / 4;
+}
+
+/**
+ * @brief 阶段1, 2: DMA线程和消费者并发
+ */
+static void __test_concurrent (int overrun)
+{
+    pthread_t dma;
+    uint32_t  buf[__TEST_WORDS];
+    uint32_t  last = 0, seed = 5;
+    size_t    n, i;
+    int       done, synced = !overrun;
+
+    lm_ringbuf_init(&__g_rb, (uint8_t *)__g_pool, sizeof(__g_pool));
+    __g_overrun  = overrun;
+    __g_dma_done = 0;
+
+    pthread_create(&dma, NULL, __test_dma, NULL);
+
+    do {
+        done = __atomic_load_n(&__g_dma_done, __ATOMIC_ACQUIRE);
+
+        n = __test_read(buf, __test_rand(&seed) % __TEST_WORDS + 1, &seed);
+        for (i = 0; i < n; i++) {
+            /* 溢出时DMA停止后读到的第一个字作为同步点, 之后必须连续 */
+            if (!synced && done) {
+                synced = 1;
+            } else if (synced && buf[i] != last + 1) {
+                __TEST_FAIL("word %u is %u\n", (unsigned)(last + 1), buf[i]);
+            }
+            last = buf[i];
+        }
+        if (n == 0) {
+            sched_yield();
+        }
+    } while (!done || n);
+
+    pthread_join(dma, NULL);
+
+    if (last != __TEST_TOTAL) {
+        __TEST_FAIL("last word %u, expect %u\n", last, (unsigned)__TEST_TOTAL);
+    }
+    if (lm_ringbuf_data_len(&__g_rb) != 0) {
+        __TEST_FAIL("%u bytes left\n", (unsigned)lm_ringbuf_data_len(&__g_rb));
+    }
+}
+
+/**
+ * @brief 阶段3: 单线程确定性检查
+ */
+static void __test_overrun (void)
+{
+    struct lm_ringbuf_span span[2];
+    uint32_t               buf[__TEST_WORDS];
+    uint32_t               counter = 0, pos;
+    size_t                 n, i;
+
+    lm_ringbuf_init(&__g_rb, (uint8_t *)__g_pool, sizeof(__g_pool));
+
+    /* 写入2.5圈, 只能读到最新的一整圈 */
+    pos = __test_dma_write(0, __TEST_WORDS - 1, &counter);
+    lm_ringbuf_dma_update(&__g_rb, pos * 4);
+    pos = __test_dma_write(pos, __TEST_WORDS - 1, &counter);
+    lm_ringbuf_dma_update(&__g_rb, pos * 4);
+    pos = __test_dma_write(pos, __TEST_WORDS / 2, &counter);
+    lm_ringbuf_dma_update(&__g_rb, pos * 4);
+
+    if (lm_ringbuf_data_len(&__g_rb) != sizeof(__g_pool)) {
+        __TEST_FAIL("data_len %u after overrun\n", (unsigned)lm_ringbuf_data_len(&__g_rb));
+    }
+
+    n = lm_ringbuf_get(&__g_rb, (uint8_t *)buf, sizeof(buf)) / 4;
+    if (n != __TEST_WORDS) {
+        __TEST_FAIL("read %u words after overrun\n", (unsigned)n);
+    }
+    for (i = 0; i < n; i++) {
+        if (buf[i] != counter - __TEST_WORDS + 1 + i) {
+            __TEST_FAIL("word %u is %u after overrun\n", (unsigned)i, buf[i]);
+        }
+    }
+
+    /* 查看之后被覆盖(相当于消费者拷贝期间发生覆盖), 不能释放失效的数据 */
+    pos = __test_dma_write(pos, 8, &counter);
+    lm_ringbuf_dma_update(&__g_rb, pos * 4);
+    n = lm_ringbuf_peek_contig(&__g_rb, span);
+    pos = __test_dma_write(pos, __TEST_WORDS - 2, &counter);
+    lm_ringbuf_dma_update(&__g_rb, pos * 4);
+
+    if (lm_ringbuf_consume(&__g_rb, n) != 0) {
+        __TEST_FAIL("consumed data overwritten after peek\n");
+    }
+    if (lm_ringbuf_get(&__g_rb, (uint8_t *)buf, 4) != 4 ||
+        buf[0] != counter - __TEST_WORDS + 1) {
+        __TEST_FAIL("word %u after peek overrun\n", buf[0]);
+    }
+}
+
+int main (void)
+{
+    __test_overrun();
+    printf("PASS: overrun\n");
+
+    __test_concurrent(0);
+    printf("PASS: dma without overrun, %lu words\n", __TEST_TOTAL);
+
+    __test_concurrent(1);
+    printf("PASS: dma with overrun, %lu words\n", __TEST_TOTAL);
+
+    return 0;
+}
+
+/* end of file */
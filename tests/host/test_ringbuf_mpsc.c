@@ -0,0 +1,216 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : test_ringbuf_mpsc.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 多生产者记录环形缓冲区并发压力测试(主机)
+*
+* 编译运行(在仓库根目录):
+*   gcc -std=gnu99 -O2 -pthread -include tests/host/lm_host.h -Iinclude \
+*       tests/host/test_ringbuf_mpsc.c components/src/lm_ringbuf_mpsc.c \
+*       -o test_ringbuf_mpsc && ./test_ringbuf_mpsc
+*
+* 4个生产者线程向256字节的缓冲区写入变长记录, 随机选用申请/提交和整条
+* 写入接口, 申请和提交之间随机让出CPU, 使后申请的记录先提交. 记录带有
+* 生产者编号, 序号和按序号生成的数据, 消费者随机选用查看/释放和读出
+* 接口, 校验每个生产者的序号连续, 数据完整. 短记录和接近上限的长记录
+* 混合, 末尾的填充记录也会被频繁用到.
+*******************************************************************************/
+
+#include "lm_ringbuf_mpsc.h"
+#include <sched.h>
+#include <string.h>
+
+pthread_mutex_t __g_lm_host_critical = PTHREAD_MUTEX_INITIALIZER;
+
+/* 生产者个数和每个生产者写入的记录数 */
+#define __TEST_PRODUCERS    4
+#define __TEST_RECORDS      100000UL
+
+/* 缓冲区大小和最长记录(缓冲区的一半减去记录头) */
+#define __TEST_POOL_SIZE    256
+#define __TEST_REC_MAX      (__TEST_POOL_SIZE / 2 - 4)
+
+/* 记录开头: 生产者编号(1字节) + 序号(4字节) */
+#define __TEST_REC_HDR      5
+
+static struct lm_ringbuf_mpsc __g_rb;
+static uint32_t               __g_pool[__TEST_POOL_SIZE / 4];
+
+#define __TEST_FAIL(...)    do { printf("FAIL: " __VA_ARGS__); exit(1); } while (0)
+
+/**
+ * @brief 线性同余伪随机数
+ */
+static uint32_t __test_rand (uint32_t *p_seed)
+{
+    *p_seed = *p_seed * 1103515245u + 12345u;
+
+    return *p_seed >> 16;
+}
+
+/**
+ * @brief 记录长度, 由生产者编号和序号决定, 消费者据此校验
+ */
+static size_t __test_len (uint8_t id, uint32_t seq)
+{
+    uint32_t seed = seq * 31 + id;
+
+    /* 大约八分之一是接近上限的长记录 */
+    if ((__test_rand(&seed) & 7) == 0) {
+        return __TEST_REC_MAX - __test_rand(&seed) % 8;
+    }
+
+    return __TEST_REC_HDR + __test_rand(&seed) % 24;
+}
+
+/**
+ * @brief 填写一条记录
+ */
+static void __test_fill (uint8_t *p_buf, uint8_t id, uint32_t seq, size_t len)
+{
+    size_t i;
+
+    p_buf[0] = id;
+    memcpy(&p_buf[1], &seq, 4);
+    for (i = __TEST_REC_HDR; i < len; i++) {
+        p_buf[i] = (uint8_t)(seq + i * 7 + id);
+    }
+}
+
+/**
+ * @brief 生产者线程
+ */
+static void *__test_producer (void *p_arg)
+{
+    uint8_t  id = (uint8_t)(uintptr_t)p_arg;
+    uint8_t  buf[__TEST_REC_MAX];
+    uint8_t *p_data;
+    uint32_t seq = 0, seed = id;
+    size_t   len;
+
+    while (seq < __TEST_RECORDS) {
+        len = __test_len(id, seq);
+
+        if (__test_rand(&seed) & 1) {
+            p_data = lm_ringbuf_mpsc_claim(&__g_rb, len);
+            if (p_data == NULL) {
+                sched_yield();
+                continue;
+            }
+
+            /* 申请之后让出CPU, 其他生产者后申请先提交 */
+            if ((__test_rand(&seed) & 3) == 0) {
+                sched_yield();
+            }
+            __test_fill(p_data, id, seq, len);
+            lm_ringbuf_mpsc_commit(&__g_rb, p_data);
+        } else {
+            __test_fill(buf, id, seq, len);
+            if (lm_ringbuf_mpsc_put(&__g_rb, buf, len) != len) {
+                sched_yield();
+                continue;
+            }
+        }
+
+        seq++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 校验一条记录
+ */
+static void __test_check (const uint8_t *p_data, size_t len, uint32_t *p_next)
+{
+    uint8_t  expect[__TEST_REC_MAX];
+    uint8_t  id;
+    uint32_t seq;
+
+    if (len < __TEST_REC_HDR) {
+        __TEST_FAIL("record of %u bytes\n", (unsigned)len);
+    }
+
+    id = p_data[0];
+    memcpy(&seq, &p_data[1], 4);
+
+    if (id >= __TEST_PRODUCERS) {
+        __TEST_FAIL("record from producer %u\n", id);
+    }
+    if (seq != p_next[id]) {
+        __TEST_FAIL("producer %u record %u, expect %u\n", id, seq, p_next[id]);
+    }
+    if (len != __test_len(id, seq)) {
+        __TEST_FAIL("producer %u record %u is %u bytes, expect %u\n",
+                    id, seq, (unsigned)len, (unsigned)__test_len(id, seq));
+    }
+
+    __test_fill(expect, id, seq, len);
+    if (memcmp(p_data, expect, len) != 0) {
+        __TEST_FAIL("producer %u record %u corrupted\n", id, seq);
+    }
+
+    p_next[id]++;
+}
+
+int main (void)
+{
+    pthread_t      producer[__TEST_PRODUCERS];
+    uint8_t        buf[__TEST_REC_MAX];
+    const uint8_t *p_data;
+    uint32_t       next[__TEST_PRODUCERS] = {0};
+    uint32_t       seed = 11;
+    unsigned long  got  = 0;
+    size_t         len;
+    int            i;
+
+    if (lm_ringbuf_mpsc_init(&__g_rb, (uint8_t *)__g_pool, sizeof(__g_pool)) != LM_OK) {
+        __TEST_FAIL("init\n");
+    }
+
+    for (i = 0; i < __TEST_PRODUCERS; i++) {
+        pthread_create(&producer[i], NULL, __test_producer, (void *)(uintptr_t)i);
+    }
+
+    while (got < __TEST_PRODUCERS * __TEST_RECORDS) {
+        if (__test_rand(&seed) & 1) {
+            p_data = lm_ringbuf_mpsc_peek(&__g_rb, &len);
+            if (p_data == NULL) {
+                sched_yield();
+                continue;
+            }
+            __test_check(p_data, len, next);
+            lm_ringbuf_mpsc_release(&__g_rb);
+        } else {
+            len = lm_ringbuf_mpsc_get(&__g_rb, buf, sizeof(buf));
+            if (len == 0) {
+                sched_yield();
+                continue;
+            }
+            __test_check(buf, len, next);
+        }
+        got++;
+    }
+
+    for (i = 0; i < __TEST_PRODUCERS; i++) {
+        pthread_join(producer[i], NULL);
+    }
+
+    if (lm_ringbuf_mpsc_peek(&__g_rb, &len) != NULL) {
+        __TEST_FAIL("records left\n");
+    }
+
+    printf("PASS: %d producers, %lu records\n", __TEST_PRODUCERS, got);
+
+    return 0;
+}
+
+/* end of file */
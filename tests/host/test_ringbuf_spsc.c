@@ -0,0 +1,184 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : test_ringbuf_spsc.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 环形缓冲区SPSC并发压力测试(主机)
+*
+* 编译运行(在仓库根目录):
+*   gcc -std=gnu99 -O2 -pthread -include tests/host/lm_host.h -Iinclude \
+*       tests/host/test_ringbuf_spsc.c components/src/lm_ringbuf.c \
+*       -o test_ringbuf_spsc && ./test_ringbuf_spsc
+*
+* 生产者和消费者线程各自随机选用拷贝接口和零拷贝接口, 传输一个递增的
+* 字节序列, 消费者逐字节校验, 任何乱序, 重复或丢失都会导致失败.
+*******************************************************************************/
+
+#include "lm_ringbuf.h"
+#include <sched.h>
+
+pthread_mutex_t __g_lm_host_critical = PTHREAD_MUTEX_INITIALIZER;
+
+/* 传输的总字节数 */
+#define __TEST_TOTAL        20000000UL
+
+/* 单次操作的最大长度 */
+#define __TEST_CHUNK_MAX    97
+
+static struct lm_ringbuf __g_rb;
+
+/* 缓冲区大小取奇数, 回绕位置不与操作长度对齐 */
+static uint8_t __g_pool[1021];
+
+/**
+ * @brief 线性同余伪随机数
+ */
+static uint32_t __test_rand (uint32_t *p_seed)
+{
+    *p_seed = *p_seed * 1103515245u + 12345u;
+
+    return *p_seed >> 16;
+}
+
+/**
+ * @brief 生产者线程
+ */
+static void *__test_producer (void *p_arg)
+{
+    struct lm_ringbuf_span span[2];
+    uint8_t                buf[__TEST_CHUNK_MAX];
+    unsigned long          sent = 0;
+    uint32_t               seed = 1;
+    size_t                 n, w, i, j;
+
+    (void)p_arg;
+
+    while (sent < __TEST_TOTAL) {
+        n = __test_rand(&seed) % __TEST_CHUNK_MAX + 1;
+        if (n > __TEST_TOTAL - sent) {
+            n = __TEST_TOTAL - sent;
+        }
+
+        switch (__test_rand(&seed) % 3) {
+
+        case 0:
+            for (i = 0; i < n; i++) {
+                buf[i] = (uint8_t)(sent + i);
+            }
+            w = lm_ringbuf_put(&__g_rb, buf, n);
+            break;
+
+        case 1:
+            w = lm_ringbuf_putchar(&__g_rb, (uint8_t)sent);
+            break;
+
+        default:
+            w = lm_ringbuf_reserve(&__g_rb, n, span);
+            for (j = 0; j < w; j++) {
+                i = (j < span[0].len) ? 0 : 1;
+                span[i].ptr[i ? j - span[0].len : j] = (uint8_t)(sent + j);
+            }
+            w = lm_ringbuf_commit(&__g_rb, w);
+            break;
+        }
+
+        sent += w;
+        if (w == 0) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 消费者线程
+ */
+static void *__test_consumer (void *p_arg)
+{
+    struct lm_ringbuf_span span[2];
+    uint8_t                buf[__TEST_CHUNK_MAX];
+    unsigned long          got = 0;
+    uint32_t               seed = 7;
+    size_t                 n, r, i, j;
+
+    (void)p_arg;
+
+    while (got < __TEST_TOTAL) {
+        n = __test_rand(&seed) % __TEST_CHUNK_MAX + 1;
+
+        switch (__test_rand(&seed) % 3) {
+
+        case 0:
+            r = lm_ringbuf_get(&__g_rb, buf, n);
+            break;
+
+        case 1:
+            r = lm_ringbuf_getchar(&__g_rb, buf);
+            break;
+
+        default:
+            r = lm_ringbuf_peek_contig(&__g_rb, span);
+            if (r > n) {
+                r = n;
+            }
+            for (j = 0; j < r; j++) {
+                i      = (j < span[0].len) ? 0 : 1;
+                buf[j] = span[i].ptr[i ? j - span[0].len : j];
+            }
+            r = lm_ringbuf_consume(&__g_rb, r);
+            break;
+        }
+
+        if (r > (size_t)__g_rb.buffer_size) {
+            printf("FAIL: read %u bytes from a %d byte ring\n",
+                   (unsigned)r, __g_rb.buffer_size);
+            exit(1);
+        }
+
+        for (i = 0; i < r; i++) {
+            if (buf[i] != (uint8_t)(got + i)) {
+                printf("FAIL: byte %lu is 0x%02x, expect 0x%02x\n",
+                       got + i, buf[i], (uint8_t)(got + i));
+                exit(1);
+            }
+        }
+
+        got += r;
+        if (r == 0) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+int main (void)
+{
+    pthread_t producer, consumer;
+
+    lm_ringbuf_init(&__g_rb, __g_pool, sizeof(__g_pool));
+
+    pthread_create(&producer, NULL, __test_producer, NULL);
+    pthread_create(&consumer, NULL, __test_consumer, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    if (lm_ringbuf_data_len(&__g_rb) != 0) {
+        printf("FAIL: %u bytes left\n", (unsigned)lm_ringbuf_data_len(&__g_rb));
+        return 1;
+    }
+
+    printf("PASS: %lu bytes\n", __TEST_TOTAL);
+
+    return 0;
+}
+
+/* end of file */
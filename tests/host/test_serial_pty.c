@@ -0,0 +1,207 @@
+/********************************* Copyright(c) ********************************
+*
+*                          LANMENG Scientific Creation
+*                          https: //www.lmiracle.com
+*
+* File Name     : test_serial_pty.c
+* Change Logs   :
+* Date          Author          Notes
+* 2026-10-17    agent           V1.0    first version
+*******************************************************************************/
+
+/*******************************************************************************
+* Description   : 伪终端串口冒烟测试(主机, FreeRTOS POSIX移植)
+*
+* 编译运行(在仓库根目录):
+*   gcc -std=gnu99 -O2 -pthread -DUSING_OS_FREERTOS \
+*       -Ibsp/posix -Ifreertos/include -Ifreertos/portable/GCC/Posix \
+*       -Ifreertos/osif -Iarch/posix/include -Iinclude \
+*       -Icomponents/driver/include \
+*       tests/host/test_serial_pty.c bsp/posix/lm_serial_pty.c \
+*       components/driver/source/serial/lm_serial.c components/src/lm_ringbuf.c \
+*       freertos/tasks.c freertos/queue.c freertos/list.c freertos/timers.c \
+*       freertos/event_groups.c freertos/portable/GCC/Posix/port.c \
+*       freertos/portable/MemMang/heap_3.c freertos/osif/osif_freertos.c \
+*       freertos/osif/osif_static_support.c \
+*       -o test_serial_pty && ./test_serial_pty
+*
+* 在真实的FreeRTOS内核(POSIX移植)上运行串口框架和伪终端驱动: 打开伪终端
+* slave端, lm_serial_write()写出的数据从slave端读回, slave端写入的数据
+* 由lm_serial_read()读回, 两个方向都逐字节校验.
+*******************************************************************************/
+
+#include "lm_serial_pty.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* 每个方向传输的字节数, 大于接收任务一次交付的数据 */
+#define __TEST_LEN          1000
+
+/* 每个方向最多等待的时间(ms) */
+#define __TEST_WAIT_MS      2000
+
+/* 整个测试的超时(s), 调度卡死时由SIGALRM结束进程 */
+#define __TEST_ALARM_S      10
+
+#define __TEST_FAIL(...)    do { printf("FAIL: " __VA_ARGS__); exit(1); } while (0)
+
+static struct lm_serial_pty __g_pty;
+static uint8_t              __g_rx_buf[2048];
+
+/**
+ * @brief 生成测试数据
+ */
+static void __test_fill (uint8_t *p_buf, size_t len, uint8_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        p_buf[i] = (uint8_t)(i * 7 + seed);
+    }
+}
+
+/**
+ * @brief 打开伪终端slave端, 原始模式, 非阻塞
+ *
+ * 任务线程阻塞在主机系统调用上会停住整个调度器, 只能轮询
+ */
+static int __test_open_slave (const char *p_name)
+{
+    struct termios tio;
+    int            fd;
+
+    fd = open(p_name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        __TEST_FAIL("open %s\n", p_name);
+    }
+
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    return fd;
+}
+
+/**
+ * @brief lm_serial_write() -> slave端
+ */
+static void __test_tx (int fd)
+{
+    uint8_t  expect[__TEST_LEN], buf[__TEST_LEN];
+    size_t   got = 0;
+    uint32_t wait = 0;
+    ssize_t  len;
+
+    __test_fill(expect, sizeof(expect), 0x11);
+
+    if (lm_serial_write(COM0, expect, sizeof(expect)) != sizeof(expect)) {
+        __TEST_FAIL("lm_serial_write\n");
+    }
+
+    while ((got < sizeof(buf)) && (wait < __TEST_WAIT_MS)) {
+        len = read(fd, &buf[got], sizeof(buf) - got);
+        if (len > 0) {
+            got += len;
+        } else {
+            vTaskDelay(1);
+            wait++;
+        }
+    }
+
+    if (got != sizeof(buf)) {
+        __TEST_FAIL("tx: slave got %u of %u bytes\n", (unsigned)got, (unsigned)sizeof(buf));
+    }
+    if (memcmp(buf, expect, sizeof(buf)) != 0) {
+        __TEST_FAIL("tx: data corrupted\n");
+    }
+}
+
+/**
+ * @brief slave端 -> lm_serial_read()
+ */
+static void __test_rx (int fd)
+{
+    struct lm_serial_info info;
+    uint8_t               expect[__TEST_LEN], buf[__TEST_LEN];
+    size_t                got = 0;
+    lm_tick_t             start;
+    int                   len;
+
+    __test_fill(expect, sizeof(expect), 0x5a);
+
+    /* 默认读超时为0(不等待), 读在信号量上阻塞时接收任务才能运行 */
+    lm_serial_get_info(COM0, &info);
+    info.read_timeout = 100;
+    if (lm_serial_set_info(COM0, &info) != LM_OK) {
+        __TEST_FAIL("lm_serial_set_info\n");
+    }
+
+    if (write(fd, expect, sizeof(expect)) != sizeof(expect)) {
+        __TEST_FAIL("write slave\n");
+    }
+
+    start = lm_sys_get_tick();
+    while ((got < sizeof(buf)) &&
+           (lm_tick_to_ms(lm_sys_get_tick() - start) < __TEST_WAIT_MS)) {
+        len = lm_serial_read(COM0, &buf[got], sizeof(buf) - got);
+        if (len < 0) {
+            __TEST_FAIL("lm_serial_read: %d\n", len);
+        }
+        got += len;
+    }
+
+    if (got != sizeof(buf)) {
+        __TEST_FAIL("rx: got %u of %u bytes\n", (unsigned)got, (unsigned)sizeof(buf));
+    }
+    if (memcmp(buf, expect, sizeof(buf)) != 0) {
+        __TEST_FAIL("rx: data corrupted\n");
+    }
+}
+
+/**
+ * @brief 测试任务
+ */
+static void __test_task (void *p_arg)
+{
+    int fd, ret;
+
+    (void)p_arg;
+
+    ret = lm_serial_pty_init(&__g_pty, COM0, __g_rx_buf, sizeof(__g_rx_buf));
+    if (ret != LM_OK) {
+        __TEST_FAIL("lm_serial_pty_init: %d\n", ret);
+    }
+
+    fd = __test_open_slave(lm_serial_pty_get_name(&__g_pty));
+
+    __test_tx(fd);
+    __test_rx(fd);
+
+    close(fd);
+
+    printf("PASS: %u bytes each way through %s\n",
+           (unsigned)__TEST_LEN, lm_serial_pty_get_name(&__g_pty));
+    exit(0);
+}
+
+int main (void)
+{
+    alarm(__TEST_ALARM_S);
+
+    if (lm_task_create("test", __test_task, configMINIMAL_STACK_SIZE,
+                       tskIDLE_PRIORITY + 1, NULL) != LM_TYPE_PASS) {
+        __TEST_FAIL("lm_task_create\n");
+    }
+
+    lm_scheduler_start();
+
+    __TEST_FAIL("scheduler returned\n");
+}
+
+/* end of file */
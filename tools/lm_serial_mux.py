@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# ******************************** Copyright(c) ********************************
+#
+#                          LANMENG Scientific Creation
+#                          https: //www.lmiracle.com
+#
+# File Name     : lm_serial_mux.py
+# Change Logs   :
+# Date          Author          Notes
+# 2026-10-17    agent           V1.0    first version
+# ******************************************************************************
+
+"""
+串口逻辑通道解复用工具(主机端), 与lm_serial_mux.c配合使用.
+
+每个逻辑通道映射为一个伪终端, minicom等工具打开对应的伪终端即可
+单独访问shell, ulog, 遥测等通道. 伪终端没有被打开或读得太慢时丢弃
+该通道的数据, 不阻塞其他通道. 统计有变化时每隔几秒输出到stderr,
+退出时再输出一次.
+
+用法: lm_serial_mux.py /dev/ttyUSB0 [-b 115200] [-n 4]
+"""
+
+import argparse
+import os
+import pty
+import select
+import sys
+import termios
+import time
+import tty
+
+MTU = 64
+
+# 统计输出的间隔(s)
+STATS_INTERVAL = 5
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_pos] = code
+                code_pos, code = len(out), 1
+                out.append(0)
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            return None
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frames(chan, data):
+    for i in range(0, len(data), MTU):
+        raw = bytes([chan]) + data[i:i + MTU]
+        yield cobs_encode(raw + bytes([crc8(raw)])) + b"\x00"
+
+
+def open_port(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    if hasattr(termios, "B%d" % baud):
+        attr = termios.tcgetattr(fd)
+        attr[4] = attr[5] = getattr(termios, "B%d" % baud)
+        termios.tcsetattr(fd, termios.TCSANOW, attr)
+    return fd
+
+
+def report(stats):
+    print("frames=%(frames)d crc_errors=%(crc_errors)d "
+          "unknown_chan=%(unknown_chan)d dropped=%(dropped)d" % stats,
+          file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="serial channel demux")
+    parser.add_argument("port", help="physical serial port or pty")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("-n", "--chans", type=int, default=4)
+    args = parser.parse_args()
+
+    dev = open_port(args.port, args.baud)
+
+    chans = {}
+    for chan in range(args.chans):
+        master, slave = pty.openpty()
+        tty.setraw(slave)
+        os.set_blocking(master, False)
+        chans[master] = chan
+        print("chan %d <-> %s" % (chan, os.ttyname(slave)))
+
+    stats = {"frames": 0, "crc_errors": 0, "unknown_chan": 0, "dropped": 0}
+    try:
+        serve(dev, chans, stats)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        report(stats)
+
+
+def serve(dev, chans, stats):
+    masters = {chan: fd for fd, chan in chans.items()}
+    frame = bytearray()
+    last = dict(stats)
+    next_report = time.monotonic() + STATS_INTERVAL
+
+    while True:
+        timeout = max(next_report - time.monotonic(), 0)
+        rlist, _, _ = select.select([dev] + list(chans), [], [], timeout)
+
+        if time.monotonic() >= next_report:
+            if stats != last:
+                report(stats)
+                last.update(stats)
+            next_report = time.monotonic() + STATS_INTERVAL
+
+        for fd in rlist:
+            data = os.read(fd, 4096)
+            if fd != dev:
+                for f in encode_frames(chans[fd], data):
+                    os.write(dev, f)
+                continue
+
+            for b in data:
+                if b != 0:
+                    frame.append(b)
+                    continue
+                if not frame:
+                    continue
+                raw = cobs_decode(bytes(frame))
+                frame.clear()
+                if raw is None or len(raw) < 2 or crc8(raw[:-1]) != raw[-1]:
+                    stats["crc_errors"] += 1
+                elif raw[0] not in masters:
+                    stats["unknown_chan"] += 1
+                else:
+                    stats["frames"] += 1
+                    # 伪终端缓冲区满时丢弃这个通道放不下的数据
+                    try:
+                        n = os.write(masters[raw[0]], raw[1:-1])
+                    except BlockingIOError:
+                        n = 0
+                    stats["dropped"] += len(raw) - 2 - n
+
+
+if __name__ == "__main__":
+    main()